@@ -0,0 +1,301 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Асинхронные операции над матрицами на общем пуле потоков
+//
+// multiply_async и т.п. сразу возвращают TFuture, а работа выполняется в
+// пуле async_pool(). Зависимые операции цепляются через then / combine:
+// продолжение ставится в очередь, когда готовы аргументы, и ни один поток
+// (ни вызывающий, ни рабочий) не блокируется в ожидании.
+
+#ifndef __TAsync_H__
+#define __TAsync_H__
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include "tmatrix.h"
+
+// Пул с фиксированным числом рабочих потоков и общей очередью задач
+class TTaskPool
+{
+protected:
+  vector<thread> workers;
+  queue<function<void()>> tasks;
+  mutex m;
+  condition_variable cv;
+  bool stop;
+
+  void work()
+  {
+    // параллелизм - между задачами: ядра внутри задачи однопоточны
+    set_local_num_threads(1);
+    for (;;)
+    {
+      function<void()> task;
+      {
+        unique_lock<mutex> g(m);
+        cv.wait(g, [this] { return stop || !tasks.empty(); });
+        if (tasks.empty())
+          return;
+        task = std::move(tasks.front());
+        tasks.pop();
+      }
+      task();
+    }
+  }
+public:
+  explicit TTaskPool(size_t threads) : stop(false)
+  {
+    if (threads == 0)
+      threads = 1;
+    for (size_t t = 0; t < threads; t++)
+      workers.emplace_back([this] { work(); });
+  }
+  TTaskPool(const TTaskPool&) = delete;
+  TTaskPool& operator=(const TTaskPool&) = delete;
+  // оставшиеся в очереди задачи выполняются до завершения потоков
+  ~TTaskPool()
+  {
+    {
+      lock_guard<mutex> g(m);
+      stop = true;
+    }
+    cv.notify_all();
+    for (auto& w : workers)
+      w.join();
+  }
+
+  size_t size() const noexcept { return workers.size(); }
+  void submit(function<void()> task)
+  {
+    {
+      lock_guard<mutex> g(m);
+      tasks.push(std::move(task));
+    }
+    cv.notify_one();
+  }
+};
+
+// общий пул библиотеки; число потоков - get_num_threads() при первом вызове.
+// Операции в задачах пула выполняются в одном потоке (set_local_num_threads)
+inline TTaskPool& async_pool()
+{
+  static TTaskPool pool(get_num_threads());
+  return pool;
+}
+
+// Общее состояние результата: значение или исключение и список продолжений
+template<typename T>
+struct TAsyncState
+{
+  mutex m;
+  condition_variable cv;
+  bool done = false;
+  optional<T> value;
+  exception_ptr error;
+  vector<function<void()>> next;
+
+  // вызывается ровно один раз; продолжения запускаются вне блокировки
+  void finish()
+  {
+    vector<function<void()>> cont;
+    {
+      lock_guard<mutex> g(m);
+      done = true;
+      cont.swap(next);
+    }
+    cv.notify_all();
+    for (auto& c : cont)
+      c();
+  }
+  // c() - сразу, если результат готов, иначе после finish()
+  void on_ready(function<void()> c)
+  {
+    {
+      lock_guard<mutex> g(m);
+      if (!done)
+      {
+        next.push_back(std::move(c));
+        return;
+      }
+    }
+    c();
+  }
+};
+
+template<typename T> class TFuture;
+
+// результат f() в новом состоянии; исключение f сохраняется в состоянии
+template<typename T, typename F>
+void async_complete(const shared_ptr<TAsyncState<T>>& st, F& f)
+{
+  try
+  {
+    st->value.emplace(f());
+  }
+  catch (...)
+  {
+    st->error = current_exception();
+  }
+  st->finish();
+}
+
+// запуск f() в пуле
+template<typename F>
+auto run_async(F f) -> TFuture<decltype(f())>
+{
+  using R = decltype(f());
+  auto st = make_shared<TAsyncState<R>>();
+  async_pool().submit([st, f = std::move(f)]() mutable { async_complete(st, f); });
+  return TFuture<R>(st);
+}
+
+// Результат асинхронной операции. Копии ссылаются на одно состояние
+// (как shared_future), get() можно вызывать многократно.
+template<typename T>
+class TFuture
+{
+protected:
+  shared_ptr<TAsyncState<T>> st;
+
+  template<typename U> friend class TFuture;
+  template<typename A, typename B, typename F>
+  friend auto combine(const TFuture<A>& a, const TFuture<B>& b, F f)
+    -> TFuture<decltype(f(declval<const A&>(), declval<const B&>()))>;
+public:
+  TFuture() = default;
+  explicit TFuture(shared_ptr<TAsyncState<T>> s) : st(std::move(s)) {}
+
+  bool valid() const noexcept { return st != nullptr; }
+  bool ready() const
+  {
+    if (!st)
+      throw("Error!Future has no state");
+    lock_guard<mutex> g(st->m);
+    return st->done;
+  }
+  void wait() const
+  {
+    if (!st)
+      throw("Error!Future has no state");
+    unique_lock<mutex> g(st->m);
+    st->cv.wait(g, [this] { return st->done; });
+  }
+  // ждёт результат; исключение операции перебрасывается вызывающему
+  const T& get() const
+  {
+    wait();
+    if (st->error)
+      rethrow_exception(st->error);
+    return *st->value;
+  }
+
+  // f(результат) в пуле после готовности; исключение передаётся дальше,
+  // не вызывая f
+  template<typename F>
+  auto then(F f) const -> TFuture<decltype(f(declval<const T&>()))>
+  {
+    using R = decltype(f(declval<const T&>()));
+    if (!st)
+      throw("Error!Future has no state");
+    auto src = st;
+    auto dst = make_shared<TAsyncState<R>>();
+    src->on_ready([src, dst, f]()
+    {
+      async_pool().submit([src, dst, f]() mutable
+      {
+        auto g = [&]() -> R
+        {
+          if (src->error)
+            rethrow_exception(src->error);
+          return f(*src->value);
+        };
+        async_complete(dst, g);
+      });
+    });
+    return TFuture<R>(dst);
+  }
+};
+
+// f(a, b) в пуле после готовности обоих аргументов
+template<typename A, typename B, typename F>
+auto combine(const TFuture<A>& a, const TFuture<B>& b, F f)
+  -> TFuture<decltype(f(declval<const A&>(), declval<const B&>()))>
+{
+  using R = decltype(f(declval<const A&>(), declval<const B&>()));
+  if (!a.st || !b.st)
+    throw("Error!Future has no state");
+  auto sa = a.st;
+  auto sb = b.st;
+  auto dst = make_shared<TAsyncState<R>>();
+  sa->on_ready([sa, sb, dst, f]()
+  {
+    sb->on_ready([sa, sb, dst, f]()
+    {
+      async_pool().submit([sa, sb, dst, f]() mutable
+      {
+        auto g = [&]() -> R
+        {
+          if (sa->error)
+            rethrow_exception(sa->error);
+          if (sb->error)
+            rethrow_exception(sb->error);
+          return f(*sa->value, *sb->value);
+        };
+        async_complete(dst, g);
+      });
+    });
+  });
+  return TFuture<R>(dst);
+}
+
+// Асинхронные варианты операций. Операнды принимаются по значению и
+// перемещаются в задачу, поэтому вызывающий может сразу менять свои
+// матрицы. Временные и переданные через std::move операнды не копируются;
+// копия матрицы в режиме set_cow(true) разделяет строки и стоит O(n);
+// остальные операнды копируются целиком в вызывающем потоке.
+template<typename T>
+TFuture<TDynamicMatrix<T>> multiply_async(TDynamicMatrix<T> a, TDynamicMatrix<T> b)
+{
+  return run_async([a = std::move(a), b = std::move(b)]()
+  {
+    TDynamicMatrix<T> res(a.size());
+    a.multiply_to(b, res);
+    return res;
+  });
+}
+template<typename T>
+TFuture<TDynamicVector<T>> multiply_async(TDynamicMatrix<T> a, TDynamicVector<T> x)
+{
+  return run_async([a = std::move(a), x = std::move(x)]()
+  {
+    TDynamicVector<T> res(a.size());
+    a.multiply_to(x, res);
+    return res;
+  });
+}
+// цепочки: операнды - результаты предыдущих асинхронных операций
+template<typename T>
+TFuture<TDynamicMatrix<T>> multiply_async(const TFuture<TDynamicMatrix<T>>& a, const TFuture<TDynamicMatrix<T>>& b)
+{
+  return combine(a, b, [](const TDynamicMatrix<T>& x, const TDynamicMatrix<T>& y)
+  {
+    TDynamicMatrix<T> res(x.size());
+    x.multiply_to(y, res);
+    return res;
+  });
+}
+template<typename T>
+TFuture<TDynamicVector<T>> multiply_async(const TFuture<TDynamicMatrix<T>>& a, const TFuture<TDynamicVector<T>>& x)
+{
+  return combine(a, x, [](const TDynamicMatrix<T>& m, const TDynamicVector<T>& v)
+  {
+    TDynamicVector<T> res(m.size());
+    m.multiply_to(v, res);
+    return res;
+  });
+}
+
+#endif
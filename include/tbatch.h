@@ -0,0 +1,199 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Пакетное умножение малых матриц
+
+#ifndef __TBatchedMatrix_H__
+#define __TBatchedMatrix_H__
+
+#include <functional>
+#include "tmatrix.h"
+
+// Раскладка пакета в памяти:
+//   Strided     - матрицы лежат подряд, элемент (b, i, j) по адресу b*n*n + i*n + j
+//   Interleaved - одноимённые элементы всех матриц лежат подряд: (i*n + j)*count + b,
+//                 внутренний цикл идёт по пакету (выгодно для n <= 16)
+enum class TBatchLayout { Strided, Interleaved };
+
+// ядро C = A * B для одной n x n матрицы в построчной раскладке
+template<typename T>
+void gemm_kernel(size_t n, const T* a, const T* b, T* c)
+{
+  std::fill(c, c + n * n, T());
+  for (size_t i = 0; i < n; i++)
+  {
+    T* r = c + i * n;
+    for (size_t k = 0; k < n; k++)
+    {
+      const T aik = a[i * n + k];
+      const T* bk = b + k * n;
+      for (size_t j = 0; j < n; j++)
+        r[j] += aik * bk[j];
+    }
+  }
+}
+
+// C[p] = A[p] * B[p], p = 0..batch-1, матрицы n x n лежат с шагом stride*
+// (stride >= n*n); пакет распределяется между потоками
+template<typename T>
+void gemm_strided_batched(size_t n, size_t batch,
+  const T* a, size_t strideA, const T* b, size_t strideB, T* c, size_t strideC)
+{
+  if (n == 0 || strideA < n * n || strideB < n * n || strideC < n * n)
+    throw("Error!Invalid batch stride");
+  parallel_for_range(0, batch, [=](size_t lo, size_t hi)
+  {
+    for (size_t p = lo; p < hi; p++)
+      gemm_kernel(n, a + p * strideA, b + p * strideB, c + p * strideC);
+  });
+}
+
+// C[p] = A[p] * B[p] для чередующейся раскладки: векторизация по пакету
+template<typename T>
+void gemm_interleaved_batched(size_t n, size_t batch, const T* a, const T* b, T* c)
+{
+  // границы блоков потоков кратны 64 элементам, чтобы потоки не делили строки кэша
+  parallel_for_range(0, batch, [=](size_t lo, size_t hi)
+  {
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = 0; j < n; j++)
+      {
+        T* r = c + (i * n + j) * batch;
+        std::fill(r + lo, r + hi, T());
+        for (size_t k = 0; k < n; k++)
+        {
+          const T* x = a + (i * n + k) * batch;
+          const T* y = b + (k * n + j) * batch;
+          for (size_t p = lo; p < hi; p++)
+            r[p] += x[p] * y[p];
+        }
+      }
+  }, 64);
+}
+
+// Пакет из count квадратных матриц n x n в одном непрерывном буфере
+template<typename T>
+class TBatchedMatrix
+{
+protected:
+  size_t n;
+  size_t cnt;
+  TBatchLayout lay;
+  T* pMem;
+
+  size_t index(size_t p, size_t i, size_t j) const noexcept
+  {
+    return (lay == TBatchLayout::Strided) ? p * n * n + i * n + j : (i * n + j) * cnt + p;
+  }
+public:
+  TBatchedMatrix(size_t size, size_t count, TBatchLayout layout = TBatchLayout::Strided)
+    : n(size), cnt(count), lay(layout)
+  {
+    if (n == 0 || cnt == 0)
+      throw out_of_range("Batch dimensions should be greater than zero");
+    if (n > get_max_matrix_size() || checked_mul(checked_mul(n, n), cnt) > get_max_vector_size())
+      throw out_of_range("max_vector_size");
+    pMem = storage_new<T>(n * n * cnt);
+  }
+  TBatchedMatrix(const TBatchedMatrix& m) : n(m.n), cnt(m.cnt), lay(m.lay)
+  {
+    pMem = storage_new<T>(n * n * cnt);
+    std::copy(m.pMem, m.pMem + n * n * cnt, pMem);
+  }
+  TBatchedMatrix(TBatchedMatrix&& m) noexcept : n(0), cnt(0), lay(m.lay), pMem(nullptr)
+  {
+    swap(*this, m);
+  }
+  ~TBatchedMatrix()
+  {
+    storage_delete(pMem, n * n * cnt);
+  }
+  TBatchedMatrix& operator=(TBatchedMatrix m) noexcept
+  {
+    swap(*this, m);
+    return *this;
+  }
+
+  size_t size() const noexcept { return n; }
+  size_t count() const noexcept { return cnt; }
+  TBatchLayout layout() const noexcept { return lay; }
+  T* data() noexcept { return pMem; }
+  const T* data() const noexcept { return pMem; }
+
+  // элемент (i, j) матрицы номер p
+  T& operator()(size_t p, size_t i, size_t j) { return pMem[index(p, i, j)]; }
+  const T& operator()(size_t p, size_t i, size_t j) const { return pMem[index(p, i, j)]; }
+
+  // обмен с обычными матрицами
+  void set(size_t p, const TDynamicMatrix<T>& m)
+  {
+    if (p >= cnt || m.size() != n)
+      throw("Error");
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = 0; j < n; j++)
+        pMem[index(p, i, j)] = m[i][j];
+  }
+  TDynamicMatrix<T> get(size_t p) const
+  {
+    if (p >= cnt)
+      throw("Error");
+    TDynamicMatrix<T> m(n);
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = 0; j < n; j++)
+        m[i][j] = pMem[index(p, i, j)];
+    return m;
+  }
+
+  // пакетное произведение res[p] = a[p] * b[p] без выделения памяти
+  friend void multiply(const TBatchedMatrix& a, const TBatchedMatrix& b, TBatchedMatrix& res)
+  {
+    if (a.n != b.n || a.cnt != b.cnt || a.lay != b.lay ||
+        res.n != a.n || res.cnt != a.cnt || res.lay != a.lay)
+      throw("Error!Batch shapes are not equal");
+    if (&res == &a || &res == &b)
+      throw("Error!The result must not alias an operand");
+    if (a.lay == TBatchLayout::Strided)
+      gemm_strided_batched(a.n, a.cnt, a.pMem, a.n * a.n, b.pMem, b.n * b.n, res.pMem, res.n * res.n);
+    else
+      gemm_interleaved_batched(a.n, a.cnt, a.pMem, b.pMem, res.pMem);
+  }
+
+  friend void swap(TBatchedMatrix& lhs, TBatchedMatrix& rhs) noexcept
+  {
+    swap(lhs.n, rhs.n);
+    swap(lhs.cnt, rhs.cnt);
+    swap(lhs.lay, rhs.lay);
+    swap(lhs.pMem, rhs.pMem);
+  }
+};
+
+// res[p] = a[p] * b[p] для массивов обычных матриц; результаты пишутся
+// в уже выделенные res[p], пакет распределяется между потоками.
+// Массив res не должен пересекаться с a и b (при любых индексах)
+template<typename T>
+void multiply_batch(const TDynamicMatrix<T>* a, const TDynamicMatrix<T>* b, TDynamicMatrix<T>* res, size_t count)
+{
+  const less<const TDynamicMatrix<T>*> before;
+  auto overlaps = [&](const TDynamicMatrix<T>* x)
+  {
+    return before(x, res + count) && before(res, x + count);
+  };
+
+  if (count > 0 && (overlaps(a) || overlaps(b)))
+    throw("Error!The result must not alias an operand");
+  for (size_t p = 0; p < count; p++)
+  {
+    if (a[p].size() != b[p].size())
+      throw("Error");
+  }
+  parallel_for_range(0, count, [=](size_t lo, size_t hi)
+  {
+    for (size_t p = lo; p < hi; p++)
+    {
+      if (res[p].size() != a[p].size())
+        res[p] = TDynamicMatrix<T>(a[p].size());
+      a[p].multiply_rows(b[p], res[p], 0, a[p].size());
+    }
+  });
+}
+
+#endif
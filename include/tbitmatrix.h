@@ -0,0 +1,256 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Битовая булева матрица
+
+#ifndef __TBitMatrix_H__
+#define __TBitMatrix_H__
+
+#include "tsemiring.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// число единичных битов в слове
+inline size_t popcount64(uint64_t x) noexcept
+{
+#if defined(_MSC_VER)
+  return static_cast<size_t>(__popcnt64(x));
+#else
+  return static_cast<size_t>(__builtin_popcountll(x));
+#endif
+}
+
+// Квадратная булева матрица n x n, по биту на элемент: строка занимает
+// bit_words(n) слов, строки лежат подряд в одном буфере. Биты за n-м
+// столбцом всегда нулевые, поэтому поэлементные операции и подсчёты
+// работают целыми словами.
+class TBitMatrix
+{
+protected:
+  size_t n;
+  size_t words;
+  uint64_t* pMem;
+
+  // порог работы (в словах), начиная с которого строки делятся между потоками
+  static const size_t PARALLEL_BIT_WORK = 1 << 18;
+  // "четыре русских": строки B берутся группами по 8, для каждой группы
+  // строится таблица всех 256 объединений
+  static const size_t RUSSIAN_BITS = 8;
+
+  size_t row_grain(size_t work) const noexcept { return work < PARALLEL_BIT_WORK ? n : 4; }
+
+  template<typename F>
+  TBitMatrix& combine(const TBitMatrix& m, F op)
+  {
+    if (n != m.n)
+      throw("Error");
+    const size_t total = n * words;
+    for (size_t w = 0; w < total; w++)
+      pMem[w] = op(pMem[w], m.pMem[w]);
+    return *this;
+  }
+public:
+  TBitMatrix(size_t size = 1) : n(size), words(bit_words(size))
+  {
+    if (n == 0)
+      throw out_of_range("Matrix size should be greater than zero");
+    if (n > get_max_matrix_size())
+      throw out_of_range("max_matrix_size");
+    pMem = storage_new<uint64_t>(checked_mul(n, words));
+  }
+  // ненулевые элементы плотной матрицы становятся единицами
+  template<typename T>
+  explicit TBitMatrix(const TDynamicMatrix<T>& m) : TBitMatrix(m.size())
+  {
+    for (size_t i = 0; i < n; i++)
+      bits_pack(m[i].data(), n, row(i));
+  }
+  TBitMatrix(const TBitMatrix& m) : n(m.n), words(m.words)
+  {
+    pMem = storage_new<uint64_t>(n * words);
+    std::copy(m.pMem, m.pMem + n * words, pMem);
+  }
+  TBitMatrix(TBitMatrix&& m) noexcept : n(0), words(0), pMem(nullptr)
+  {
+    swap(*this, m);
+  }
+  ~TBitMatrix()
+  {
+    storage_delete(pMem, n * words);
+  }
+  TBitMatrix& operator=(TBitMatrix m) noexcept
+  {
+    swap(*this, m);
+    return *this;
+  }
+
+  size_t size() const noexcept { return n; }
+  size_t words_per_row() const noexcept { return words; }
+  uint64_t* row(size_t i) noexcept { return pMem + i * words; }
+  const uint64_t* row(size_t i) const noexcept { return pMem + i * words; }
+
+  // доступ к элементам
+  bool get(size_t i, size_t j) const
+  {
+    if (i >= n || j >= n)
+      throw out_of_range("Index out of range");
+    return (row(i)[j / 64] >> (j % 64)) & 1;
+  }
+  void set(size_t i, size_t j, bool value)
+  {
+    if (i >= n || j >= n)
+      throw out_of_range("Index out of range");
+    const uint64_t bit = uint64_t(1) << (j % 64);
+    if (value)
+      row(i)[j / 64] |= bit;
+    else
+      row(i)[j / 64] &= ~bit;
+  }
+  template<typename T>
+  TDynamicMatrix<T> toDense() const
+  {
+    TDynamicMatrix<T> m(n);
+    for (size_t i = 0; i < n; i++)
+      bits_unpack(row(i), n, m[i].data());
+    return m;
+  }
+
+  // сравнение
+  bool operator==(const TBitMatrix& m) const noexcept
+  {
+    return n == m.n && std::equal(pMem, pMem + n * words, m.pMem);
+  }
+  bool operator!=(const TBitMatrix& m) const noexcept
+  {
+    return !(*this == m);
+  }
+
+  // поэлементные операции целыми словами
+  TBitMatrix& operator&=(const TBitMatrix& m) { return combine(m, [](uint64_t a, uint64_t b) { return a & b; }); }
+  TBitMatrix& operator|=(const TBitMatrix& m) { return combine(m, [](uint64_t a, uint64_t b) { return a | b; }); }
+  TBitMatrix& operator^=(const TBitMatrix& m) { return combine(m, [](uint64_t a, uint64_t b) { return a ^ b; }); }
+  TBitMatrix operator&(const TBitMatrix& m) const { TBitMatrix res(*this); return res &= m; }
+  TBitMatrix operator|(const TBitMatrix& m) const { TBitMatrix res(*this); return res |= m; }
+  TBitMatrix operator^(const TBitMatrix& m) const { TBitMatrix res(*this); return res ^= m; }
+
+  // булево произведение (or, and) методом четырёх русских: на каждую группу
+  // из 8 строк m строится таблица 256 объединений, после чего вклад группы
+  // в строку результата - одно пословное OR по байту строки *this
+  TBitMatrix operator*(const TBitMatrix& m) const
+  {
+    TMATRIX_OP("bit_gemm", n, n * n * words / RUSSIAN_BITS, 3 * n * words * sizeof(uint64_t));
+    if (n != m.n)
+      throw("Error");
+    TBitMatrix res(n);
+    const size_t entries = size_t(1) << RUSSIAN_BITS;
+
+    parallel_for_range(0, n, [&](size_t lo, size_t hi)
+    {
+      vector<uint64_t> table(entries * words);
+
+      for (size_t g = 0; g < n; g += RUSSIAN_BITS)
+      {
+        const size_t bits = min(RUSSIAN_BITS, n - g);
+        // table[x] = table[x без младшего бита] | строка младшего бита
+        std::fill(table.begin(), table.begin() + words, uint64_t(0));
+        for (size_t x = 1; x < (size_t(1) << bits); x++)
+        {
+          size_t low = 0;
+          while (!((x >> low) & 1))
+            low++;
+          const uint64_t* prev = table.data() + (x & (x - 1)) * words;
+          const uint64_t* b = m.row(g + low);
+          uint64_t* t = table.data() + x * words;
+          for (size_t w = 0; w < words; w++)
+            t[w] = prev[w] | b[w];
+        }
+        for (size_t i = lo; i < hi; i++)
+        {
+          const size_t x = (row(i)[g / 64] >> (g % 64)) & ((size_t(1) << bits) - 1);
+          if (x == 0)
+            continue;
+          const uint64_t* t = table.data() + x * words;
+          uint64_t* r = res.row(i);
+          for (size_t w = 0; w < words; w++)
+            r[w] |= t[w];
+        }
+      }
+    }, row_grain(n * n * words / RUSSIAN_BITS));
+    return res;
+  }
+
+  // транзитивное замыкание A+ (пути длины >= 1): R = R | R * R до
+  // стабилизации, не более log2(n) + 1 произведений
+  TBitMatrix transitive_closure() const
+  {
+    TMATRIX_OP("bit_closure", n, n * n * words / RUSSIAN_BITS, 3 * n * words * sizeof(uint64_t));
+    TBitMatrix r(*this);
+
+    for (;;)
+    {
+      TBitMatrix next = r * r;
+      next |= r;
+      if (next == r)
+        return r;
+      r = std::move(next);
+    }
+  }
+
+  // статистика по числу единиц
+  size_t count() const noexcept
+  {
+    size_t c = 0;
+    for (size_t w = 0; w < n * words; w++)
+      c += popcount64(pMem[w]);
+    return c;
+  }
+  // степени исходящих (по строкам) и входящих (по столбцам) рёбер
+  TDynamicVector<size_t> row_counts() const
+  {
+    TDynamicVector<size_t> res(n);
+    size_t* r = res.data();
+    for (size_t i = 0; i < n; i++)
+    {
+      const uint64_t* a = row(i);
+      size_t c = 0;
+      for (size_t w = 0; w < words; w++)
+        c += popcount64(a[w]);
+      r[i] = c;
+    }
+    return res;
+  }
+  TDynamicVector<size_t> col_counts() const
+  {
+    TDynamicVector<size_t> res(n);
+    size_t* r = res.data();
+    for (size_t i = 0; i < n; i++)
+    {
+      const uint64_t* a = row(i);
+      for (size_t j = 0; j < n; j++)
+        r[j] += (a[j / 64] >> (j % 64)) & 1;
+    }
+    return res;
+  }
+  // число общих единиц строк i и j (общие соседи вершин)
+  size_t common(size_t i, size_t j) const
+  {
+    if (i >= n || j >= n)
+      throw out_of_range("Index out of range");
+    const uint64_t* a = row(i);
+    const uint64_t* b = row(j);
+    size_t c = 0;
+    for (size_t w = 0; w < words; w++)
+      c += popcount64(a[w] & b[w]);
+    return c;
+  }
+
+  friend void swap(TBitMatrix& lhs, TBitMatrix& rhs) noexcept
+  {
+    swap(lhs.n, rhs.n);
+    swap(lhs.words, rhs.words);
+    swap(lhs.pMem, rhs.pMem);
+  }
+};
+
+#endif
@@ -9,11 +9,570 @@
 
 #include <iostream>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "tmemstat.h"
+#include "tprofile.h"
+#include "ttrace.h"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
-const int MAX_VECTOR_SIZE = 100000000;
-const int MAX_MATRIX_SIZE = 10000;
+// Точка наблюдения за открытой операцией: профилирование (TMATRIX_PROFILE)
+// и трассировка (TMATRIX_TRACE); без этих макросов ничего не делает
+#define TMATRIX_OP(name, n, flops, bytes) \
+  TMATRIX_PROFILE_OP(name, n, flops, bytes); \
+  TMATRIX_TRACE_OP(name, n)
+
+// Ограничения размеров -
+// значения по умолчанию задаются при сборке (-DTMATRIX_MAX_VECTOR_SIZE=...,
+// -DTMATRIX_MAX_MATRIX_SIZE=...) и меняются во время работы set_max_*_size
+#ifndef TMATRIX_MAX_VECTOR_SIZE
+#define TMATRIX_MAX_VECTOR_SIZE 100000000
+#endif
+#ifndef TMATRIX_MAX_MATRIX_SIZE
+#define TMATRIX_MAX_MATRIX_SIZE 10000
+#endif
+const size_t MAX_VECTOR_SIZE = TMATRIX_MAX_VECTOR_SIZE;
+const size_t MAX_MATRIX_SIZE = TMATRIX_MAX_MATRIX_SIZE;
+
+inline atomic<size_t>& tmatrix_max_vector_size()
+{
+  static atomic<size_t> n(MAX_VECTOR_SIZE);
+  return n;
+}
+inline atomic<size_t>& tmatrix_max_matrix_size()
+{
+  static atomic<size_t> n(MAX_MATRIX_SIZE);
+  return n;
+}
+inline void set_max_vector_size(size_t n) { tmatrix_max_vector_size() = n; }
+inline size_t get_max_vector_size() { return tmatrix_max_vector_size(); }
+inline void set_max_matrix_size(size_t n) { tmatrix_max_matrix_size() = n; }
+inline size_t get_max_matrix_size() { return tmatrix_max_matrix_size(); }
+
+// a * b с проверкой переполнения size_t (для rows * cols * sizeof(T))
+inline size_t checked_mul(size_t a, size_t b)
+{
+  if (b != 0 && a > SIZE_MAX / b)
+    throw out_of_range("size_overflow");
+  return a * b;
+}
+
+// Параллельное выполнение -
+// число потоков задаётся set_num_threads (по умолчанию - число ядер)
+inline atomic<size_t>& tmatrix_num_threads()
+{
+  static atomic<size_t> n(max<size_t>(1, thread::hardware_concurrency()));
+  return n;
+}
+inline void set_num_threads(size_t n) { tmatrix_num_threads() = (n == 0) ? 1 : n; }
+// число потоков для ядер, вызванных из текущего потока (0 - общее значение);
+// рабочие потоки пула tasync.h задают 1, чтобы P одновременных задач
+// занимали P потоков пула, а не P * get_num_threads()
+inline size_t& tmatrix_local_num_threads()
+{
+  thread_local size_t n = 0;
+  return n;
+}
+inline void set_local_num_threads(size_t n) { tmatrix_local_num_threads() = n; }
+inline size_t get_num_threads()
+{
+  const size_t local = tmatrix_local_num_threads();
+  return local != 0 ? local : tmatrix_num_threads().load();
+}
+
+// Число потоков на время жизни объекта; прежнее значение
+// восстанавливается и при выходе по исключению
+class TNumThreadsGuard
+{
+  size_t prev;
+public:
+  explicit TNumThreadsGuard(size_t n) : prev(get_num_threads()) { set_num_threads(n); }
+  TNumThreadsGuard(const TNumThreadsGuard&) = delete;
+  TNumThreadsGuard& operator=(const TNumThreadsGuard&) = delete;
+  ~TNumThreadsGuard() { set_num_threads(prev); }
+};
+
+// Делит [begin, end) на непрерывные блоки (границы кратны grain)
+// и вызывает f(lo, hi) для каждого блока в отдельном потоке
+template<typename F>
+void parallel_for_range(size_t begin, size_t end, F f, size_t grain = 1)
+{
+  if (begin >= end)
+    return;
+  if (grain == 0)
+    grain = 1;
+  size_t chunks = (end - begin + grain - 1) / grain;
+  size_t nt = min(get_num_threads(), chunks);
+  if (nt <= 1)
+  {
+    f(begin, end);
+    return;
+  }
+  size_t step = (chunks + nt - 1) / nt * grain;
+  vector<thread> workers;
+  vector<exception_ptr> errors(nt);
+  // рабочие потоки продолжают вложенность профиля вызывающего
+  const int depth = TMATRIX_PROFILE_DEPTH();
+  for (size_t t = 1; t < nt; t++)
+  {
+    size_t lo = begin + t * step, hi = min(end, lo + step);
+    if (lo >= hi)
+      break;
+    workers.emplace_back([&f, &errors, t, lo, hi, depth]()
+    {
+      TMATRIX_PROFILE_NESTED(depth);
+      TMATRIX_TRACE_OP("parallel_block", hi - lo);
+      try { f(lo, hi); }
+      catch (...) { errors[t] = current_exception(); }
+    });
+  }
+  try { f(begin, min(end, begin + step)); }
+  catch (...) { errors[0] = current_exception(); }
+  for (auto& w : workers)
+    w.join();
+  for (auto& e : errors)
+    if (e)
+      rethrow_exception(e);
+}
+
+// Распределение памяти -
+// буферы от страницы и больше выравниваются по странице, чтобы к ним
+// можно было применить политику NUMA до первого касания
+enum class TNumaPolicy
+{
+  Default,     // как решит ОС
+  FirstTouch,  // инициализация теми же потоками, что потом обрабатывают блоки
+  Interleave,  // страницы чередуются по всем узлам
+  Bind         // все страницы на заданном узле
+};
+
+// Крупные страницы (2 МиБ) для буферов от STORAGE_HUGE_THRESHOLD байт
+enum class THugePages
+{
+  Default,      // как решит ОС (настройка transparent_hugepage)
+  None,         // только обычные страницы (MADV_NOHUGEPAGE)
+  Transparent,  // прозрачные крупные страницы (MADV_HUGEPAGE)
+  Explicit      // заранее выделенный пул (MAP_HUGETLB), при нехватке - как Transparent
+};
+
+const size_t STORAGE_PAGE_SIZE = 4096;
+const size_t STORAGE_HUGE_PAGE_SIZE = size_t(2) << 20;
+const size_t STORAGE_HUGE_THRESHOLD = STORAGE_HUGE_PAGE_SIZE;
+
+inline atomic<THugePages>& tmatrix_huge_pages()
+{
+  static atomic<THugePages> mode(THugePages::Default);
+  return mode;
+}
+// режим действует на буферы, выделяемые после вызова
+inline void set_huge_pages(THugePages mode) { tmatrix_huge_pages() = mode; }
+inline THugePages get_huge_pages() { return tmatrix_huge_pages(); }
+
+inline size_t storage_alignment(size_t bytes) noexcept
+{
+  return (bytes >= STORAGE_PAGE_SIZE) ? STORAGE_PAGE_SIZE : __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+}
+
+#ifdef __linux__
+// крупные буферы отображаются через mmap; длина всегда кратна 2 МиБ,
+// поэтому освобождение не зависит от режима, в котором буфер выделен
+inline size_t storage_huge_length(size_t bytes) noexcept
+{
+  return (bytes + STORAGE_HUGE_PAGE_SIZE - 1) / STORAGE_HUGE_PAGE_SIZE * STORAGE_HUGE_PAGE_SIZE;
+}
+inline void* storage_map(size_t bytes)
+{
+  const size_t len = storage_huge_length(bytes);
+  const THugePages mode = get_huge_pages();
+
+#ifdef MAP_HUGETLB
+  if (mode == THugePages::Explicit)
+  {
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#ifdef MAP_HUGE_SHIFT
+    flags |= 21 << MAP_HUGE_SHIFT;
+#endif
+    void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (p != MAP_FAILED)
+      return p;
+  }
+#endif
+  // запас в одну крупную страницу для выравнивания, лишнее возвращается ОС
+  const size_t span = len + STORAGE_HUGE_PAGE_SIZE;
+  void* raw = mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (raw == MAP_FAILED)
+    throw bad_alloc();
+  char* base = static_cast<char*>(raw);
+  char* p = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(base) + STORAGE_HUGE_PAGE_SIZE - 1)
+    / STORAGE_HUGE_PAGE_SIZE * STORAGE_HUGE_PAGE_SIZE);
+  if (p > base)
+    munmap(base, p - base);
+  if (base + span > p + len)
+    munmap(p + len, base + span - (p + len));
+#if defined(MADV_HUGEPAGE) && defined(MADV_NOHUGEPAGE)
+  if (mode == THugePages::Transparent || mode == THugePages::Explicit)
+    madvise(p, len, MADV_HUGEPAGE);
+  else if (mode == THugePages::None)
+    madvise(p, len, MADV_NOHUGEPAGE);
+#endif
+  return p;
+}
+#endif
+
+inline void* storage_allocate(size_t bytes)
+{
+  void* p = nullptr;
+#ifdef __linux__
+  if (bytes >= STORAGE_HUGE_THRESHOLD)
+    p = storage_map(bytes);
+#endif
+  if (p == nullptr)
+    p = ::operator new(bytes, align_val_t(storage_alignment(bytes)));
+  TMATRIX_TRACK_ALLOC(bytes);
+  return p;
+}
+inline void storage_deallocate(void* p, size_t bytes) noexcept
+{
+  TMATRIX_TRACK_FREE(bytes);
+#ifdef __linux__
+  if (bytes >= STORAGE_HUGE_THRESHOLD)
+  {
+    munmap(p, storage_huge_length(bytes));
+    return;
+  }
+#endif
+  ::operator delete(p, align_val_t(storage_alignment(bytes)));
+}
+
+// n значений T() в памяти storage_allocate (для буферов вне TDynamicVector)
+template<typename T>
+T* storage_new(size_t n)
+{
+  T* p = static_cast<T*>(storage_allocate(checked_mul(n, sizeof(T))));
+
+  try
+  {
+    uninitialized_value_construct_n(p, n);
+  }
+  catch (...)
+  {
+    storage_deallocate(p, n * sizeof(T));
+    throw;
+  }
+  return p;
+}
+template<typename T>
+void storage_delete(T* p, size_t n) noexcept
+{
+  if (p == nullptr)
+    return;
+  destroy_n(p, n);
+  storage_deallocate(p, n * sizeof(T));
+}
+
+// Политика Interleave/Bind для ещё не тронутых страниц [p, p + bytes);
+// false, если политика не применена (нет поддержки NUMA, узел не существует)
+inline bool numa_bind(void* p, size_t bytes, TNumaPolicy policy, int node = 0)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+  const int MPOL_BIND_MODE = 2, MPOL_INTERLEAVE_MODE = 3;
+  if (policy != TNumaPolicy::Interleave && policy != TNumaPolicy::Bind)
+    return false;
+  if (bytes < STORAGE_PAGE_SIZE || reinterpret_cast<uintptr_t>(p) % STORAGE_PAGE_SIZE != 0)
+    return false;
+  if (policy == TNumaPolicy::Bind && (node < 0 || node >= 64))
+    return false;
+  // ядро само пересекает маску с существующими узлами
+  unsigned long mask = (policy == TNumaPolicy::Interleave) ? ~0UL : (1UL << node);
+  int mode = (policy == TNumaPolicy::Interleave) ? MPOL_INTERLEAVE_MODE : MPOL_BIND_MODE;
+  return syscall(SYS_mbind, p, bytes, mode, &mask, 8 * sizeof(mask) + 1, 0) == 0;
+#else
+  (void)p; (void)bytes; (void)policy; (void)node;
+  return false;
+#endif
+}
+
+// Режимы суммирования для скалярных произведений и сумм
+enum class TReduction
+{
+  Naive,     // последовательное накопление в T (как operator*)
+  Pairwise,  // попарное (каскадное) суммирование, погрешность O(log n)
+  Kahan,     // компенсированное суммирование Кэхэна
+  Wide       // накопление в более широком типе (float -> double)
+};
+
+// тип накопителя для режима Wide (и для смешанной точности, см. tmixed.h)
+template<typename T> struct TWideAccumulator { using type = T; };
+template<> struct TWideAccumulator<float> { using type = double; };
+
+// Ядра редукции term(i), i = [lo, hi). Накопление идёт в REDUCTION_LANES
+// независимых полосах: цепочки сложений не ждут друг друга и векторизуются.
+// Компенсация Кэхэна корректна только без -ffast-math.
+const size_t REDUCTION_LANES = 8;
+const size_t PAIRWISE_BLOCK = 256;
+
+template<typename Acc, typename F>
+Acc reduce_naive(size_t lo, size_t hi, F term)
+{
+  Acc s{};
+  for (size_t i = lo; i < hi; i++)
+    s += static_cast<Acc>(term(i));
+  return s;
+}
+template<typename Acc, typename F>
+Acc reduce_lanes(size_t lo, size_t hi, F term)
+{
+  Acc acc[REDUCTION_LANES] = {};
+  size_t i = lo;
+  for (; i + REDUCTION_LANES <= hi; i += REDUCTION_LANES)
+    for (size_t k = 0; k < REDUCTION_LANES; k++)
+      acc[k] += static_cast<Acc>(term(i + k));
+  for (size_t k = 0; i < hi; i++, k++)
+    acc[k] += static_cast<Acc>(term(i));
+  for (size_t w = REDUCTION_LANES / 2; w > 0; w /= 2)
+    for (size_t k = 0; k < w; k++)
+      acc[k] += acc[k + w];
+  return acc[0];
+}
+template<typename Acc, typename F>
+Acc reduce_pairwise(size_t lo, size_t hi, F term)
+{
+  if (hi - lo <= PAIRWISE_BLOCK)
+    return reduce_lanes<Acc>(lo, hi, term);
+  // середина по границе блока, чтобы полосы шли целыми блоками
+  size_t mid = lo + (hi - lo) / 2 / PAIRWISE_BLOCK * PAIRWISE_BLOCK;
+  if (mid == lo)
+    mid = lo + PAIRWISE_BLOCK;
+  return reduce_pairwise<Acc>(lo, mid, term) + reduce_pairwise<Acc>(mid, hi, term);
+}
+template<typename Acc, typename F>
+Acc reduce_kahan(size_t lo, size_t hi, F term)
+{
+  Acc s[REDUCTION_LANES] = {}, c[REDUCTION_LANES] = {};
+  size_t i = lo;
+  for (; i + REDUCTION_LANES <= hi; i += REDUCTION_LANES)
+    for (size_t k = 0; k < REDUCTION_LANES; k++)
+    {
+      Acc y = static_cast<Acc>(term(i + k)) - c[k];
+      Acc t = s[k] + y;
+      c[k] = (t - s[k]) - y;
+      s[k] = t;
+    }
+  for (size_t k = 0; i < hi; i++, k++)
+  {
+    Acc y = static_cast<Acc>(term(i)) - c[k];
+    Acc t = s[k] + y;
+    c[k] = (t - s[k]) - y;
+    s[k] = t;
+  }
+  // сложение полос с компенсацией (Ноймайер)
+  Acc sum{}, comp{};
+  for (size_t k = 0; k < REDUCTION_LANES; k++)
+  {
+    const Acc parts[2] = { s[k], -c[k] };
+    for (const Acc& x : parts)
+    {
+      Acc t = sum + x;
+      if (abs(sum) >= abs(x))
+        comp += (sum - t) + x;
+      else
+        comp += (x - t) + sum;
+      sum = t;
+    }
+  }
+  return sum + comp;
+}
+// Детерминированная параллельная редукция -
+// [lo, hi) делится на блоки по block элементов независимо от числа потоков,
+// суммы блоков складываются тем же ядром в фиксированном порядке. Поэтому
+// результат побитово одинаков при любом set_num_threads.
+const size_t REDUCE_BLOCK = 1 << 14;
+// длина, начиная с которой блоки суммируются в нескольких потоках
+const size_t PARALLEL_REDUCE_WORK = 1 << 18;
+
+template<typename Acc, typename F, typename K>
+Acc reduce_blocks(size_t lo, size_t hi, F term, K kernel, size_t block, bool parallel)
+{
+  size_t nb = (hi - lo + block - 1) / block;
+  if (nb <= 1)
+    return kernel(lo, hi, term);
+  vector<Acc> part(nb);
+  auto body = [&](size_t b0, size_t b1)
+  {
+    for (size_t b = b0; b < b1; b++)
+      part[b] = kernel(lo + b * block, min(hi, lo + (b + 1) * block), term);
+  };
+  if (parallel)
+    parallel_for_range(0, nb, body);
+  else
+    body(0, nb);
+  const Acc* p = part.data();
+  return kernel(0, nb, [p](size_t b) { return p[b]; });
+}
+// редукция с накопителем Acc; Naive всегда последовательна
+template<typename Acc, typename F>
+Acc reduce_acc(size_t lo, size_t hi, F term, TReduction mode, size_t block = REDUCE_BLOCK, bool parallel = true)
+{
+  switch (mode)
+  {
+  case TReduction::Pairwise:
+  case TReduction::Wide:
+    return reduce_blocks<Acc>(lo, hi, term,
+      [](size_t l, size_t h, auto t) { return reduce_pairwise<Acc>(l, h, t); }, block, parallel);
+  case TReduction::Kahan:
+    return reduce_blocks<Acc>(lo, hi, term,
+      [](size_t l, size_t h, auto t) { return reduce_kahan<Acc>(l, h, t); }, block, parallel);
+  default:
+    return reduce_naive<Acc>(lo, hi, term);
+  }
+}
+// редукция в выбранном режиме; результат приводится к T
+template<typename T, typename F>
+T reduce(size_t lo, size_t hi, F term, TReduction mode, size_t block = REDUCE_BLOCK, bool parallel = true)
+{
+  if (mode == TReduction::Wide)
+    return static_cast<T>(reduce_acc<typename TWideAccumulator<T>::type>(lo, hi, term, mode, block, parallel));
+  return reduce_acc<T>(lo, hi, term, mode, block, parallel);
+}
+
+// индекс первого "лучшего" элемента a[0, n): better(x, y) - x строго лучше y.
+// Блоки те же, что у редукций, победители блоков сравниваются по порядку,
+// поэтому при равенстве всегда выбирается наименьший индекс
+template<typename T, typename C>
+size_t arg_extreme(const T* a, size_t n, C better, bool parallel)
+{
+  auto scan = [a, better](size_t lo, size_t hi)
+  {
+    size_t k = lo;
+    for (size_t i = lo + 1; i < hi; i++)
+      if (better(a[i], a[k]))
+        k = i;
+    return k;
+  };
+  size_t nb = (n + REDUCE_BLOCK - 1) / REDUCE_BLOCK;
+  if (nb <= 1)
+    return scan(0, n);
+  vector<size_t> part(nb);
+  auto body = [&](size_t b0, size_t b1)
+  {
+    for (size_t b = b0; b < b1; b++)
+      part[b] = scan(b * REDUCE_BLOCK, min(n, (b + 1) * REDUCE_BLOCK));
+  };
+  if (parallel)
+    parallel_for_range(0, nb, body);
+  else
+    body(0, nb);
+  size_t k = part[0];
+  for (size_t b = 1; b < nb; b++)
+    if (better(a[part[b]], a[k]))
+      k = part[b];
+  return k;
+}
+
+// Модульная арифметика для модулей до 2^32 -
+// редукция Барретта заменяет деление на умножение на 2^64 / m
+inline uint64_t mulhi64(uint64_t a, uint64_t b) noexcept
+{
+#if defined(__SIZEOF_INT128__)
+  return static_cast<uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+#else
+  const uint64_t a0 = a & 0xffffffffu, a1 = a >> 32, b0 = b & 0xffffffffu, b1 = b >> 32;
+  const uint64_t mid = (a0 * b0 >> 32) + (a1 * b0 & 0xffffffffu) + a0 * b1;
+  return a1 * b1 + (a1 * b0 >> 32) + (mid >> 32);
+#endif
+}
+
+struct TBarrett
+{
+  uint64_t m;  // модуль, 2 <= m <= 2^32
+  uint64_t r;  // floor((2^64 - 1) / m)
+
+  explicit TBarrett(uint64_t mod) : m(mod), r(~uint64_t(0) / mod) {}
+
+  // x mod m для любого 64-битного x: частное занижено не более чем на 2
+  uint64_t reduce(uint64_t x) const noexcept
+  {
+    uint64_t t = x - mulhi64(x, r) * m;
+    if (t >= m)
+      t -= m;
+    if (t >= m)
+      t -= m;
+    return t;
+  }
+  // a * b mod m для a, b < m
+  uint64_t mul(uint64_t a, uint64_t b) const noexcept { return reduce(a * b); }
+  // сколько произведений (< m^2) можно прибавить к остатку (< m), не переполнив 64 бита
+  size_t lazy_terms() const noexcept
+  {
+    const uint64_t p = (m - 1) * (m - 1);
+    return static_cast<size_t>((~uint64_t(0) - (m - 1)) / p);
+  }
+};
+
+// обратный к a по модулю m (расширенный алгоритм Евклида); 0, если не существует
+inline uint64_t mod_inverse(uint64_t a, uint64_t m) noexcept
+{
+  int64_t t = 0, nt = 1;
+  uint64_t r = m, nr = a % m;
+  while (nr != 0)
+  {
+    const uint64_t q = r / nr;
+    const int64_t tt = t - static_cast<int64_t>(q) * nt;
+    t = nt;
+    nt = tt;
+    const uint64_t rr = r - q * nr;
+    r = nr;
+    nr = rr;
+  }
+  if (r != 1)
+    return 0;
+  return t < 0 ? static_cast<uint64_t>(t + static_cast<int64_t>(m)) : static_cast<uint64_t>(t);
+}
+
+// Поэлементные ядра: r[i] = f(p[i]...) для i = [lo, hi). Цикл по сырым
+// указателям без ветвлений векторизуется, если f встраивается
+template<typename T, typename F, typename... P>
+void elementwise_range(T* r, size_t lo, size_t hi, F& f, const P*... p)
+{
+  for (size_t i = lo; i < hi; i++)
+    r[i] = f(p[i]...);
+}
+// длина, начиная с которой поэлементные операции идут в нескольких потоках
+const size_t PARALLEL_ELEMENTWISE_WORK = 1 << 18;
+// блоки по 64 элемента, чтобы потоки не делили строки кэша результата
+const size_t ELEMENTWISE_GRAIN = 64;
+// кратность блоков строк при делении между потоками; одинакова для всех
+// построчных ядер (матричных, полукольцевых, плиточных) и для параллельной
+// инициализации (FirstTouch)
+const size_t ROW_GRAIN = 4;
+
+template<typename T, typename F, typename... P>
+void elementwise(T* r, size_t n, F& f, const P*... p)
+{
+  if (n < PARALLEL_ELEMENTWISE_WORK)
+  {
+    elementwise_range(r, 0, n, f, p...);
+    return;
+  }
+  parallel_for_range(0, n, [&](size_t lo, size_t hi) { elementwise_range(r, lo, hi, f, p...); },
+    ELEMENTWISE_GRAIN);
+}
 
 // Динамический вектор - 
 // шаблонный вектор на динамической памяти
@@ -23,39 +582,162 @@ class TDynamicVector
 protected:
   size_t sz;
   T* pMem;
+  // режим копирования при записи (COW): копии разделяют буфер,
+  // pRef - общий счётчик ссылок (nullptr - буфер принадлежит только этому объекту)
+  atomic<size_t>* pRef = nullptr;
+  bool cow = false;
+  // на буфер выданы неконстантные ссылки или указатели: запись через них
+  // не отделяет буфер, поэтому копии его не разделяют, а копируют
+  bool leaked = false;
+
+  // буфер из n элементов, инициализированных значением по умолчанию
+  static T* allocate(size_t n, TNumaPolicy policy = TNumaPolicy::Default, int node = 0)
+  {
+      T* p = static_cast<T*>(storage_allocate(checked_mul(n, sizeof(T))));
+
+      numa_bind(p, n * sizeof(T), policy, node);
+      try
+      {
+          if (policy == TNumaPolicy::FirstTouch && is_trivially_default_constructible<T>::value)
+          {
+              // каждую страницу обнуляет тот поток, который будет её обрабатывать
+              parallel_for_range(0, n, [p](size_t lo, size_t hi) { uninitialized_value_construct(p + lo, p + hi); },
+                  max<size_t>(1, STORAGE_PAGE_SIZE / sizeof(T)));
+          }
+          else
+          {
+              uninitialized_value_construct_n(p, n);
+          }
+      }
+      catch (...)
+      {
+          storage_deallocate(p, n * sizeof(T));
+          throw;
+      }
+      return p;
+  }
+  // буфер с копией n элементов src
+  static T* allocate_copy(const T* src, size_t n)
+  {
+      T* p = static_cast<T*>(storage_allocate(checked_mul(n, sizeof(T))));
+
+      try
+      {
+          uninitialized_copy_n(src, n, p);
+      }
+      catch (...)
+      {
+          storage_deallocate(p, n * sizeof(T));
+          throw;
+      }
+      return p;
+  }
+  static void deallocate(T* p, size_t n) noexcept
+  {
+      if (p == nullptr)
+      {
+          return;
+      }
+      destroy_n(p, n);
+      storage_deallocate(p, n * sizeof(T));
+  }
+
+  // освобождение своей ссылки на буфер
+  void release() noexcept
+  {
+      if (pRef == nullptr)
+      {
+          deallocate(pMem, sz);
+      }
+      else if (pRef->fetch_sub(1, memory_order_acq_rel) == 1)
+      {
+          deallocate(pMem, sz);
+          delete pRef;
+      }
+      pMem = nullptr;
+      pRef = nullptr;
+  }
+  bool shared() const noexcept
+  {
+      return pRef != nullptr && pRef->load(memory_order_acquire) > 1;
+  }
+  // получение собственной копии разделяемого буфера перед записью
+  void detach()
+  {
+      if (!shared())
+      {
+          return;
+      }
+      T* p = allocate_copy(pMem, sz);
+      atomic<size_t>* r = new atomic<size_t>(1);
+      release();
+      pMem = p;
+      pRef = r;
+  }
+  // буфер перед выдачей изменяемой ссылки: свой и больше не разделяемый
+  T* leak()
+  {
+      detach();
+      leaked = true;
+      return pMem;
+  }
 public:
   TDynamicVector(size_t size = 1) : sz(size)
   {
     if (sz == 0)
       throw out_of_range("Vector size should be greater than zero");
 
-    if (sz > MAX_VECTOR_SIZE)
+    if (sz > get_max_vector_size())
+        throw out_of_range("max_vector_size");
+
+    pMem = allocate(sz);// {}; // У типа T д.б. конструктор по умолчанию
+  }
+  // вектор с заданной политикой размещения страниц по узлам NUMA
+  TDynamicVector(size_t size, TNumaPolicy policy, int node = 0) : sz(size)
+  {
+    if (sz == 0)
+      throw out_of_range("Vector size should be greater than zero");
+
+    if (sz > get_max_vector_size())
         throw out_of_range("max_vector_size");
 
-    pMem = new T[sz]();// {}; // У типа T д.б. конструктор по умолчанию
+    pMem = allocate(sz, policy, node);
   }
   TDynamicVector(T* arr, size_t s) : sz(s)
   {
     assert(arr != nullptr && "TDynamicVector ctor requires non-nullptr arg");
-    pMem = new T[sz];
-    std::copy(arr, arr + sz, pMem);
+    if (sz > get_max_vector_size())
+        throw out_of_range("max_vector_size");
+    pMem = allocate_copy(arr, sz);
   }
   TDynamicVector(const TDynamicVector& v) //копирующий конструктор
   {
       sz = v.sz;
 
-      pMem = new T[sz];
-
-      if (pMem == nullptr)
+      if (v.cow && !v.leaked)
       {
-          throw("failed_memory");
+          // в режиме COW копия разделяет буфер до первой записи
+          v.pRef->fetch_add(1, memory_order_relaxed);
+          pMem = v.pMem;
+          pRef = v.pRef;
+          cow = true;
+          return;
       }
 
-      for (size_t i = 0; i < sz; i++)
+      pMem = allocate_copy(v.pMem, sz);
+      // копия COW-вектора остаётся в режиме COW
+      if (v.cow)
       {
-          pMem[i] = v.pMem[i];
+          try
+          {
+              set_cow(true);
+          }
+          catch (...)
+          {
+              deallocate(pMem, sz);
+              throw;
+          }
       }
-
   }
   TDynamicVector(TDynamicVector&& v) noexcept //перемещающий конструктор
   {
@@ -67,9 +749,7 @@ public:
   }
   ~TDynamicVector()
   {
-      delete[] pMem;
-
-      pMem = nullptr;
+      release();
   }
   TDynamicVector& operator=(const TDynamicVector& v) 
   {
@@ -77,22 +757,33 @@ public:
       {
           return *this;
       }
-      if (sz != v.sz)
+      if (v.cow && !v.leaked)
       {
-          T* p = new T[v.sz];
+          v.pRef->fetch_add(1, memory_order_relaxed);
+          release();
+          sz = v.sz;
+          pMem = v.pMem;
+          pRef = v.pRef;
+          cow = true;
+          leaked = false;
+          return *this;
+      }
+      if (sz != v.sz || shared())
+      {
+          T* p = allocate(v.sz);
 
-          if (p == nullptr)
-          {
-              throw("failed_memory");
-          }
-          else
-          {
-              delete[] pMem;
+          release();
 
-              sz = v.sz;
+          sz = v.sz;
 
-              pMem = p;
-          }
+          pMem = p;
+          leaked = false;
+      }
+      // режим копирования при записи остаётся прежним; после release()
+      // буферу нужен новый счётчик ссылок
+      if (cow && pRef == nullptr)
+      {
+          pRef = new atomic<size_t>(1);
       }
       for (size_t i = 0; i < sz; i++)
       {
@@ -103,9 +794,7 @@ public:
   }
   TDynamicVector& operator=(TDynamicVector&& v) noexcept
   {
-      delete[] pMem;
-
-      pMem = nullptr;
+      release();
 
       swap(*this, v);
 
@@ -114,10 +803,36 @@ public:
 
   size_t size() const noexcept { return sz; }
 
+  // включение/выключение режима копирования при записи для последующих копий.
+  // Режим не меняется присваиванием. Пока на буфер есть выданные
+  // неконстантные ссылки или указатели, копии получают собственный буфер;
+  // set_cow(true) считает, что ранее выданные ссылки больше не используются
+  // для записи
+  void set_cow(bool on)
+  {
+      if (on && pRef == nullptr)
+      {
+          pRef = new atomic<size_t>(1);
+      }
+      cow = on;
+      if (on)
+      {
+          leaked = false;
+      }
+  }
+  bool is_cow() const noexcept { return cow; }
+  // true, если буфер сейчас разделяется с другими объектами
+  bool is_shared() const noexcept { return shared(); }
+
+  // непосредственный доступ к памяти (для вычислительных ядер);
+  // неконстантный доступ отделяет разделяемый буфер
+  T* data() { return leak(); }
+  const T* data() const noexcept { return pMem; }
+
   // индексация
   T& operator[](size_t ind)
   {
-      return pMem[ind];
+      return leak()[ind];
   }
   const T& operator[](size_t ind) const
   {
@@ -130,7 +845,7 @@ public:
       {
           throw("vector is out");
       }
-      return pMem[ind];
+      return leak()[ind];
   }
   const T& at(size_t ind) const
   {
@@ -165,6 +880,7 @@ public:
   // скалярные операции
   TDynamicVector operator+(T val)
   {
+      TMATRIX_OP("vector_add_scalar", sz, sz, 2 * sz * sizeof(T));
       TDynamicVector res(sz);
 
       for (size_t i = 0; i < sz; i++)
@@ -175,6 +891,7 @@ public:
   }
   TDynamicVector operator-(T val)
   {
+      TMATRIX_OP("vector_sub_scalar", sz, sz, 2 * sz * sizeof(T));
       TDynamicVector res(sz);
 
       for (size_t i = 0; i < sz; i++)
@@ -185,6 +902,7 @@ public:
   }
   TDynamicVector operator*(T val)
   {
+      TMATRIX_OP("vector_mul_scalar", sz, sz, 2 * sz * sizeof(T));
       TDynamicVector res(sz);
 
       for (size_t i = 0; i < sz; i++)
@@ -197,10 +915,13 @@ public:
   // векторные операции
   TDynamicVector operator+(const TDynamicVector& v)
   {
+      TMATRIX_OP("vector_add", sz, sz, 3 * sz * sizeof(T));
       if (sz == v.sz)
       {
           TDynamicVector<T> res(*this);
 
+          res.detach();
+
           for (size_t i = 0; i < sz; i++)
           {
               res.pMem[i] += v.pMem[i];
@@ -215,10 +936,13 @@ public:
   }
   TDynamicVector operator-(const TDynamicVector& v)
   {
+      TMATRIX_OP("vector_sub", sz, sz, 3 * sz * sizeof(T));
       if (sz == v.sz)
       {
           TDynamicVector<T> res(*this);
 
+          res.detach();
+
           for (size_t i = 0; i < sz; i++)
           {
               res.pMem[i] -= v.pMem[i];
@@ -233,6 +957,7 @@ public:
   }
   T operator*(const TDynamicVector& v) //noexcept(noexcept(T()))
   {
+      TMATRIX_OP("dot", sz, 2 * sz, 2 * sz * sizeof(T));
       if (sz == v.sz)
       {
           T res{};
@@ -248,74 +973,772 @@ public:
           throw("Error!The lengths of the vectors are not equal");
       }
   }
+  // скалярное произведение с выбранным режимом суммирования
+  T dot(const TDynamicVector& v, TReduction mode) const
+  {
+      TMATRIX_OP("dot", sz, 2 * sz, 2 * sz * sizeof(T));
+      if (sz != v.sz)
+      {
+          throw("Error!The lengths of the vectors are not equal");
+      }
+      const T* a = pMem;
+      const T* b = v.pMem;
 
-  friend void swap(TDynamicVector& lhs, TDynamicVector& rhs) noexcept
+      if (mode == TReduction::Wide)
+      {
+          // произведения тоже считаются в широком типе
+          using W = typename TWideAccumulator<T>::type;
+          return reduce<T>(0, sz, [a, b](size_t i) { return W(a[i]) * W(b[i]); }, mode,
+              REDUCE_BLOCK, sz >= PARALLEL_REDUCE_WORK);
+      }
+      return reduce<T>(0, sz, [a, b](size_t i) { return a[i] * b[i]; }, mode,
+          REDUCE_BLOCK, sz >= PARALLEL_REDUCE_WORK);
+  }
+  // сумма элементов с выбранным режимом суммирования
+  T sum(TReduction mode = TReduction::Pairwise) const
   {
-    swap(lhs.sz, rhs.sz);
-    swap(lhs.pMem, rhs.pMem);
+      TMATRIX_OP("sum", sz, sz, sz * sizeof(T));
+      const T* a = pMem;
+
+      return reduce<T>(0, sz, [a](size_t i) { return a[i]; }, mode,
+          REDUCE_BLOCK, sz >= PARALLEL_REDUCE_WORK);
   }
 
-  // ввод/вывод
-  friend istream& operator>>(istream& istr, TDynamicVector& v)
+  // среднее значение
+  T mean(TReduction mode = TReduction::Pairwise) const
   {
-    for (size_t i = 0; i < v.sz; i++)
-      istr >> v.pMem[i]; // требуется оператор>> для типа T
-    return istr;
+      return sum(mode) / static_cast<T>(sz);
   }
-  friend ostream& operator<<(ostream& ostr, const TDynamicVector& v)
+  // нормы: сумма модулей, евклидова, максимум модуля
+  T norm1(TReduction mode = TReduction::Pairwise) const
   {
-    for (size_t i = 0; i < v.sz; i++)
-      ostr << v.pMem[i] << ' '; // требуется оператор<< для типа T
-    return ostr;
+      TMATRIX_OP("vector_norm1", sz, 2 * sz, sz * sizeof(T));
+      const T* a = pMem;
+
+      return reduce<T>(0, sz, [a](size_t i) { return abs(a[i]); }, mode,
+          REDUCE_BLOCK, sz >= PARALLEL_REDUCE_WORK);
   }
-};
+  T norm2(TReduction mode = TReduction::Pairwise) const
+  {
+      TMATRIX_OP("vector_norm2", sz, 2 * sz, sz * sizeof(T));
+      const T* a = pMem;
 
+      return static_cast<T>(sqrt(reduce<T>(0, sz, [a](size_t i) { return a[i] * a[i]; }, mode,
+          REDUCE_BLOCK, sz >= PARALLEL_REDUCE_WORK)));
+  }
+  T norm_inf() const
+  {
+      return abs(pMem[arg_extreme(pMem, sz, [](const T& x, const T& y) { return abs(x) > abs(y); },
+          sz >= PARALLEL_REDUCE_WORK)]);
+  }
+  // индексы первого минимального и максимального элементов
+  size_t argmin() const
+  {
+      TMATRIX_OP("vector_argmin", sz, sz, sz * sizeof(T));
+      return arg_extreme(pMem, sz, [](const T& x, const T& y) { return x < y; }, sz >= PARALLEL_REDUCE_WORK);
+  }
+  size_t argmax() const
+  {
+      TMATRIX_OP("vector_argmax", sz, sz, sz * sizeof(T));
+      return arg_extreme(pMem, sz, [](const T& x, const T& y) { return y < x; }, sz >= PARALLEL_REDUCE_WORK);
+  }
+  T min_value() const { return pMem[argmin()]; }
+  T max_value() const { return pMem[argmax()]; }
 
-// Динамическая матрица - 
-// шаблонная матрица на динамической памяти
-template<typename T>
-class TDynamicMatrix : private TDynamicVector<TDynamicVector<T>>
-{
-  using TDynamicVector<TDynamicVector<T>>::pMem;
-  using TDynamicVector<TDynamicVector<T>>::sz;
-public:
-  TDynamicMatrix(size_t s = 1) : TDynamicVector<TDynamicVector<T>>(s)
+  // составное присваивание (на месте, без временных векторов)
+  TDynamicVector& operator+=(const TDynamicVector& v)
   {
-      if (sz > MAX_MATRIX_SIZE)
+      TMATRIX_OP("vector_add_inplace", sz, sz, 3 * sz * sizeof(T));
+      if (sz != v.sz)
       {
-          throw out_of_range("max_vector_size");
+          throw("Error!The lengths of the vectors are not equal");
       }
+      detach();
       for (size_t i = 0; i < sz; i++)
       {
-          pMem[i] = TDynamicVector<T>(sz);
+          pMem[i] += v.pMem[i];
       }
+      return *this;
   }
-
-  using TDynamicVector<TDynamicVector<T>>::operator[];
-  using TDynamicVector<TDynamicVector<T>>::at;
-  using TDynamicVector<TDynamicVector<T>>::size;
-
-  // сравнение
-  bool operator==(const TDynamicMatrix& m) const noexcept
+  TDynamicVector& operator-=(const TDynamicVector& v)
   {
-      if (sz != m.sz)
+      TMATRIX_OP("vector_sub_inplace", sz, sz, 3 * sz * sizeof(T));
+      if (sz != v.sz)
       {
-          return 0;
+          throw("Error!The lengths of the vectors are not equal");
       }
+      detach();
       for (size_t i = 0; i < sz; i++)
       {
-          if (pMem[i] != m.pMem[i])
-          {
-              return 0;
-          }
+          pMem[i] -= v.pMem[i];
       }
-      return 1;
+      return *this;
   }
+  TDynamicVector& operator+=(T val)
+  {
+      TMATRIX_OP("vector_add_scalar_inplace", sz, sz, 2 * sz * sizeof(T));
+      detach();
+      for (size_t i = 0; i < sz; i++)
+      {
+          pMem[i] += val;
+      }
+      return *this;
+  }
+  TDynamicVector& operator-=(T val)
+  {
+      TMATRIX_OP("vector_sub_scalar_inplace", sz, sz, 2 * sz * sizeof(T));
+      detach();
+      for (size_t i = 0; i < sz; i++)
+      {
+          pMem[i] -= val;
+      }
+      return *this;
+  }
+  TDynamicVector& operator*=(T val)
+  {
+      TMATRIX_OP("vector_mul_scalar_inplace", sz, sz, 2 * sz * sizeof(T));
+      detach();
+      for (size_t i = 0; i < sz; i++)
+      {
+          pMem[i] *= val;
+      }
+      return *this;
+  }
+  // this += a * x за один проход
+  TDynamicVector& axpy(T a, const TDynamicVector& x)
+  {
+      TMATRIX_OP("axpy", sz, 2 * sz, 3 * sz * sizeof(T));
+      if (sz != x.sz)
+      {
+          throw("Error!The lengths of the vectors are not equal");
+      }
+      detach();
+      for (size_t i = 0; i < sz; i++)
+      {
+          pMem[i] += a * x.pMem[i];
+      }
+      return *this;
+  }
+  // this = a * x + b * this за один проход
+  TDynamicVector& axpby(T a, const TDynamicVector& x, T b)
+  {
+      TMATRIX_OP("axpby", sz, 3 * sz, 3 * sz * sizeof(T));
+      if (sz != x.sz)
+      {
+          throw("Error!The lengths of the vectors are not equal");
+      }
+      detach();
+      for (size_t i = 0; i < sz; i++)
+      {
+          pMem[i] = a * x.pMem[i] + b * pMem[i];
+      }
+      return *this;
+  }
+
+  // поэлементные операции: f вызывается для каждого элемента, на больших
+  // векторах - из нескольких потоков. Цепочку преобразований выгоднее
+  // собрать в одну f (или один zip) - тогда хватает одного прохода по памяти
+  template<typename F>
+  TDynamicVector map(F f) const
+  {
+      TMATRIX_OP("vector_map", sz, sz, 2 * sz * sizeof(T));
+      TDynamicVector res(sz);
+
+      elementwise(res.pMem, sz, f, static_cast<const T*>(pMem));
+      return res;
+  }
+  template<typename F>
+  TDynamicVector& apply(F f)
+  {
+      TMATRIX_OP("vector_apply", sz, sz, 2 * sz * sizeof(T));
+      detach();
+      elementwise(pMem, sz, f, static_cast<const T*>(pMem));
+      return *this;
+  }
+  // res[i] = f(a[i], rest[i]...) за один проход по всем операндам
+  template<typename F, typename... V>
+  friend TDynamicVector zip(F f, const TDynamicVector& a, const V&... rest)
+  {
+      TMATRIX_OP("vector_zip", a.sz, a.sz, (sizeof...(V) + 2) * a.sz * sizeof(T));
+      if ((false || ... || (rest.size() != a.sz)))
+      {
+          throw("Error!The lengths of the vectors are not equal");
+      }
+      TDynamicVector res(a.sz);
+
+      elementwise(res.pMem, a.sz, f, static_cast<const T*>(a.pMem), rest.data()...);
+      return res;
+  }
+  friend TDynamicVector hadamard(const TDynamicVector& a, const TDynamicVector& b)
+  {
+      return zip([](const T& x, const T& y) { return x * y; }, a, b);
+  }
+  friend TDynamicVector divide(const TDynamicVector& a, const TDynamicVector& b)
+  {
+      return zip([](const T& x, const T& y) { return x / y; }, a, b);
+  }
+  friend TDynamicVector abs(const TDynamicVector& v)
+  {
+      return v.map([](const T& x) { return abs(x); });
+  }
+  friend TDynamicVector exp(const TDynamicVector& v)
+  {
+      return v.map([](const T& x) { return static_cast<T>(exp(x)); });
+  }
+  friend TDynamicVector clamp(const TDynamicVector& v, const T& lo, const T& hi)
+  {
+      return v.map([lo, hi](const T& x) { return x < lo ? lo : (hi < x ? hi : x); });
+  }
+
+  friend void swap(TDynamicVector& lhs, TDynamicVector& rhs) noexcept
+  {
+    swap(lhs.sz, rhs.sz);
+    swap(lhs.pMem, rhs.pMem);
+    swap(lhs.pRef, rhs.pRef);
+    swap(lhs.cow, rhs.cow);
+    swap(lhs.leaked, rhs.leaked);
+  }
+
+  // ввод/вывод
+  friend istream& operator>>(istream& istr, TDynamicVector& v)
+  {
+    v.detach();
+    for (size_t i = 0; i < v.sz; i++)
+      istr >> v.pMem[i]; // требуется оператор>> для типа T
+    return istr;
+  }
+  friend ostream& operator<<(ostream& ostr, const TDynamicVector& v)
+  {
+    for (size_t i = 0; i < v.sz; i++)
+      ostr << v.pMem[i] << ' '; // требуется оператор<< для типа T
+    return ostr;
+  }
+};
+
+
+// Динамическая матрица - 
+// шаблонная матрица на динамической памяти
+template<typename T>
+class TDynamicMatrix : private TDynamicVector<TDynamicVector<T>>
+{
+  using TDynamicVector<TDynamicVector<T>>::pMem;
+  using TDynamicVector<TDynamicVector<T>>::sz;
+
+  // объём работы (n^3), начиная с которого умножение распараллеливается
+  static const size_t PARALLEL_GEMM_WORK = 1 << 21;
+  // то же для умножения на вектор (n^2)
+  static const size_t PARALLEL_GEMV_WORK = 1 << 18;
+  // кратность блоков столбцов (целые строки кэша) в постолбцовых редукциях
+  static const size_t COL_GRAIN = 64;
+
+  // строка только для чтения (не отделяет разделяемую память)
+  const T* row(size_t i) const noexcept
+  {
+      return static_cast<const TDynamicVector<T>&>(pMem[i]).data();
+  }
+
+  // детерминированная редукция term(a, j) по всем элементам (a - строка)
+  template<typename Acc, typename F>
+  Acc reduce_rows(TReduction mode, F term) const
+  {
+      const TDynamicVector<T>* rows = pMem;
+      const size_t n = sz;
+
+      return reduce_acc<Acc>(0, n, [rows, n, mode, term](size_t i)
+      {
+          const T* a = rows[i].data();
+          return reduce_acc<Acc>(0, n, [a, term](size_t j) { return term(a, j); }, mode, REDUCE_BLOCK, false);
+      }, mode, ROW_GRAIN, sz * sz >= PARALLEL_REDUCE_WORK);
+  }
+  // res[j] = step(...step(init(a[0][j]), a[1][j])..., a[n-1][j]);
+  // столбцы делятся между потоками блоками по COL_GRAIN
+  template<typename I, typename S>
+  TDynamicVector<T> reduce_cols(I init, S step) const
+  {
+      TDynamicVector<T> res(sz);
+      T* r = res.data();
+
+      parallel_for_range(0, sz, [&](size_t lo, size_t hi)
+      {
+          const T* a = row(0);
+          for (size_t j = lo; j < hi; j++)
+          {
+              r[j] = init(a[j]);
+          }
+          for (size_t i = 1; i < sz; i++)
+          {
+              a = row(i);
+              for (size_t j = lo; j < hi; j++)
+              {
+                  r[j] = step(r[j], a[j]);
+              }
+          }
+      }, sz * sz >= PARALLEL_REDUCE_WORK ? COL_GRAIN : sz);
+      return res;
+  }
+  // out[j - lo] = сумма term(a[i][j]) по строкам [i0, i1) для столбцов [lo, hi).
+  // Строки читаются подряд; Pairwise и Wide делят строки пополам до блоков по
+  // PAIRWISE_BLOCK / REDUCTION_LANES (цепочка сложений той же длины, что у
+  // полосы в reduce_lanes), Kahan ведёт поправку для каждого столбца
+  template<typename Acc, typename F>
+  void sum_cols_range(size_t i0, size_t i1, size_t lo, size_t hi, Acc* out, TReduction mode, F term) const
+  {
+      const size_t w = hi - lo;
+
+      if (mode == TReduction::Kahan)
+      {
+          vector<Acc> c(w);
+          fill(out, out + w, Acc{});
+          for (size_t i = i0; i < i1; i++)
+          {
+              const T* a = row(i);
+              for (size_t j = 0; j < w; j++)
+              {
+                  Acc y = static_cast<Acc>(term(a[lo + j])) - c[j];
+                  Acc t = out[j] + y;
+                  c[j] = (t - out[j]) - y;
+                  out[j] = t;
+              }
+          }
+          return;
+      }
+      const size_t block = PAIRWISE_BLOCK / REDUCTION_LANES;
+      if (mode == TReduction::Naive || i1 - i0 <= block)
+      {
+          fill(out, out + w, Acc{});
+          for (size_t i = i0; i < i1; i++)
+          {
+              const T* a = row(i);
+              for (size_t j = 0; j < w; j++)
+              {
+                  out[j] += static_cast<Acc>(term(a[lo + j]));
+              }
+          }
+          return;
+      }
+      size_t mid = i0 + (i1 - i0) / 2 / block * block;
+      if (mid == i0)
+      {
+          mid = i0 + block;
+      }
+      vector<Acc> right(w);
+      sum_cols_range<Acc>(i0, mid, lo, hi, out, mode, term);
+      sum_cols_range<Acc>(mid, i1, lo, hi, right.data(), mode, term);
+      for (size_t j = 0; j < w; j++)
+      {
+          out[j] += right[j];
+      }
+  }
+  // суммы term по столбцам в выбранном режиме; результат столбца не зависит
+  // от того, какому потоку достался его диапазон
+  template<typename Acc, typename F>
+  TDynamicVector<T> sum_cols_acc(TReduction mode, F term) const
+  {
+      TDynamicVector<T> res(sz);
+      T* r = res.data();
+
+      parallel_for_range(0, sz, [&](size_t lo, size_t hi)
+      {
+          vector<Acc> acc(hi - lo);
+          sum_cols_range<Acc>(0, sz, lo, hi, acc.data(), mode, term);
+          for (size_t j = lo; j < hi; j++)
+          {
+              r[j] = static_cast<T>(acc[j - lo]);
+          }
+      }, sz * sz >= PARALLEL_REDUCE_WORK ? COL_GRAIN : sz);
+      return res;
+  }
+  template<typename F>
+  TDynamicVector<T> sum_cols(TReduction mode, F term) const
+  {
+      if (mode == TReduction::Wide)
+      {
+          return sum_cols_acc<typename TWideAccumulator<T>::type>(mode, term);
+      }
+      return sum_cols_acc<T>(mode, term);
+  }
+  // первый "лучший" элемент каждой строки (см. arg_extreme)
+  template<typename C>
+  TDynamicVector<T> row_extreme(C better) const
+  {
+      TDynamicVector<T> res(sz);
+      T* r = res.data();
+
+      parallel_for_range(0, sz, [&](size_t lo, size_t hi)
+      {
+          for (size_t i = lo; i < hi; i++)
+          {
+              const T* a = row(i);
+              r[i] = a[arg_extreme(a, sz, better, false)];
+          }
+      }, sz * sz >= PARALLEL_REDUCE_WORK ? ROW_GRAIN : sz);
+      return res;
+  }
+  // body(i, r) для каждой строки; r - строка i, отделённая для записи
+  template<typename F>
+  void for_rows(F body)
+  {
+      this->detach();
+      parallel_for_range(0, sz, [&](size_t lo, size_t hi)
+      {
+          for (size_t i = lo; i < hi; i++)
+          {
+              body(i, pMem[i].data());
+          }
+      }, sz * sz >= PARALLEL_ELEMENTWISE_WORK ? ROW_GRAIN : sz);
+  }
+  // определитель по простому модулю p <= 2^32 методом Гаусса; элементы
+  // могут быть любыми целыми (отрицательные приводятся к [0, p))
+  friend T det_mod(const TDynamicMatrix& a, T p)
+  {
+      static_assert(is_integral<T>::value, "modular determinant requires an integer type");
+      const size_t n = a.sz;
+      TMATRIX_OP("det_mod", n, 2 * n * n * n / 3, n * n * sizeof(uint64_t));
+      if (p < 2 || static_cast<uint64_t>(p) > (uint64_t(1) << 32))
+      {
+          throw("Error!Invalid modulus");
+      }
+      const TBarrett q(static_cast<uint64_t>(p));
+      vector<uint64_t> w(n * n);
+
+      for (size_t i = 0; i < n; i++)
+      {
+          const T* r = a.row(i);
+          for (size_t j = 0; j < n; j++)
+          {
+              const T x = r[j] % p;
+              w[i * n + j] = static_cast<uint64_t>(x < 0 ? x + p : x);
+          }
+      }
+      uint64_t det = 1;
+      for (size_t c = 0; c < n; c++)
+      {
+          size_t piv = c;
+          while (piv < n && w[piv * n + c] == 0)
+          {
+              piv++;
+          }
+          if (piv == n)
+          {
+              return T(0);
+          }
+          if (piv != c)
+          {
+              swap_ranges(w.begin() + piv * n + c, w.begin() + piv * n + n, w.begin() + c * n + c);
+              det = q.m - det;
+          }
+          const uint64_t pc = w[c * n + c];
+          const uint64_t inv = mod_inverse(pc, q.m);
+          // при составном модуле опорный элемент может оказаться необратимым
+          if (inv == 0)
+          {
+              throw("Error!Pivot is not invertible: modulus must be prime");
+          }
+          const uint64_t* top = w.data() + c * n;
+
+          det = q.mul(det, pc);
+          // строки ниже опорной независимы и делятся между потоками
+          parallel_for_range(c + 1, n, [&](size_t lo, size_t hi)
+          {
+              for (size_t i = lo; i < hi; i++)
+              {
+                  uint64_t* r = w.data() + i * n;
+                  if (r[c] == 0)
+                  {
+                      continue;
+                  }
+                  const uint64_t f = q.m - q.mul(r[c], inv);
+                  for (size_t j = c; j < n; j++)
+                  {
+                      r[j] = q.reduce(r[j] + f * top[j]);
+                  }
+              }
+          }, (n - c) * (n - c) < PARALLEL_GEMV_WORK ? n : ROW_GRAIN);
+      }
+      return static_cast<T>(det);
+  }
+
+  // общий цикл возведения в степень; mul(x, y, r) пишет x * y в r,
+  // load(x) - элемент основания (для pow_mod - приведённый по модулю)
+  template<typename F, typename L>
+  TDynamicMatrix power(unsigned long long k, F mul, L load) const
+  {
+      size_t products = 0;
+
+      for (unsigned long long x = k; x > 1; x >>= 1)
+      {
+          products += 1 + (x & 1);
+      }
+      TMATRIX_OP("matrix_pow", sz, products * 2 * sz * sz * sz, products * 3 * sz * sz * sizeof(T));
+      TDynamicMatrix res(sz), base(sz), work(sz);
+      bool started = false;
+
+      for (size_t i = 0; i < sz; i++)
+      {
+          std::transform(row(i), row(i) + sz, base.pMem[i].data(), load);
+      }
+      while (k)
+      {
+          if (k & 1)
+          {
+              if (started)
+              {
+                  mul(res, base, work);
+                  swap(res, work);
+              }
+              else
+              {
+                  for (size_t i = 0; i < sz; i++)
+                  {
+                      std::copy(base.row(i), base.row(i) + sz, res.pMem[i].data());
+                  }
+                  started = true;
+              }
+          }
+          k >>= 1;
+          if (k)
+          {
+              mul(base, base, work);
+              swap(base, work);
+          }
+      }
+      if (!started)
+      {
+          for (size_t i = 0; i < sz; i++)
+          {
+              res.pMem[i].data()[i] = T(1);
+          }
+      }
+      return res;
+  }
+  // первый по порядку строк "лучший" элемент матрицы
+  template<typename C>
+  pair<size_t, size_t> arg_extreme_rows(C better) const
+  {
+      vector<size_t> col(sz);
+
+      parallel_for_range(0, sz, [&](size_t lo, size_t hi)
+      {
+          for (size_t i = lo; i < hi; i++)
+          {
+              col[i] = arg_extreme(row(i), sz, better, false);
+          }
+      }, sz * sz >= PARALLEL_REDUCE_WORK ? ROW_GRAIN : sz);
+      size_t k = 0;
+      for (size_t i = 1; i < sz; i++)
+      {
+          if (better(row(i)[col[i]], row(k)[col[k]]))
+          {
+              k = i;
+          }
+      }
+      return make_pair(k, col[k]);
+  }
+  // проверка размера до выделения строк: s <= get_max_matrix_size()
+  // и s * s * sizeof(T) представимо в size_t
+  static size_t checked_size(size_t s)
+  {
+      if (s > get_max_matrix_size())
+      {
+          throw out_of_range("max_matrix_size");
+      }
+      checked_mul(checked_mul(s, s), sizeof(T));
+      return s;
+  }
+public:
+  TDynamicMatrix(size_t s = 1) : TDynamicVector<TDynamicVector<T>>(checked_size(s))
+  {
+      for (size_t i = 0; i < sz; i++)
+      {
+          pMem[i] = TDynamicVector<T>(sz);
+      }
+  }
+  // матрица с политикой NUMA: при FirstTouch строки выделяются и обнуляются
+  // потоками в том же разбиении, что используют умножения
+  TDynamicMatrix(size_t s, TNumaPolicy policy, int node = 0) : TDynamicVector<TDynamicVector<T>>(checked_size(s))
+  {
+      if (policy == TNumaPolicy::FirstTouch)
+      {
+          parallel_for_range(0, sz, [&](size_t lo, size_t hi)
+          {
+              for (size_t i = lo; i < hi; i++)
+              {
+                  pMem[i] = TDynamicVector<T>(sz);
+              }
+          }, ROW_GRAIN);
+      }
+      else
+      {
+          for (size_t i = 0; i < sz; i++)
+          {
+              pMem[i] = TDynamicVector<T>(sz, policy, node);
+          }
+      }
+  }
+
+  using TDynamicVector<TDynamicVector<T>>::operator[];
+  using TDynamicVector<TDynamicVector<T>>::at;
+  using TDynamicVector<TDynamicVector<T>>::size;
+  using TDynamicVector<TDynamicVector<T>>::is_cow;
+  using TDynamicVector<TDynamicVector<T>>::is_shared;
+
+  // режим копирования при записи для массива строк и каждой строки:
+  // копия матрицы разделяет память, запись отделяет только изменяемую строку
+  void set_cow(bool on)
+  {
+      this->detach();
+      TDynamicVector<TDynamicVector<T>>::set_cow(on);
+      for (size_t i = 0; i < sz; i++)
+      {
+          pMem[i].set_cow(on);
+      }
+  }
+
+  // сравнение
+  bool operator==(const TDynamicMatrix& m) const noexcept
+  {
+      if (sz != m.sz)
+      {
+          return 0;
+      }
+      for (size_t i = 0; i < sz; i++)
+      {
+          if (pMem[i] != m.pMem[i])
+          {
+              return 0;
+          }
+      }
+      return 1;
+  }
+
+
+  // сумма элементов: строки делятся на блоки по ROW_GRAIN, суммы строк
+  // и блоков складываются в фиксированном порядке (не зависит от числа потоков)
+  T sum(TReduction mode = TReduction::Pairwise) const
+  {
+      TMATRIX_OP("matrix_sum", sz, sz * sz, sz * sz * sizeof(T));
+      if (mode == TReduction::Wide)
+      {
+          return static_cast<T>(reduce_rows<typename TWideAccumulator<T>::type>(mode,
+              [](const T* a, size_t j) { return a[j]; }));
+      }
+      return reduce_rows<T>(mode, [](const T* a, size_t j) { return a[j]; });
+  }
+
+  T mean(TReduction mode = TReduction::Pairwise) const
+  {
+      return sum(mode) / static_cast<T>(sz * sz);
+  }
+  // норма Фробениуса
+  T frobenius_norm(TReduction mode = TReduction::Pairwise) const
+  {
+      TMATRIX_OP("matrix_frobenius_norm", sz, 2 * sz * sz, sz * sz * sizeof(T));
+      auto square = [](const T* a, size_t j) { return a[j] * a[j]; };
+
+      if (mode == TReduction::Wide)
+      {
+          return static_cast<T>(sqrt(reduce_rows<typename TWideAccumulator<T>::type>(mode, square)));
+      }
+      return static_cast<T>(sqrt(reduce_rows<T>(mode, square)));
+  }
+  // 1-норма (максимальная сумма модулей по столбцам)
+  T norm1(TReduction mode = TReduction::Pairwise) const
+  {
+      TMATRIX_OP("matrix_norm1", sz, 2 * sz * sz, sz * sz * sizeof(T));
+      TDynamicVector<T> s = sum_cols(mode, [](const T& a) { return abs(a); });
+
+      return s.max_value();
+  }
+  // бесконечная норма (максимальная сумма модулей по строкам)
+  T norm_inf() const
+  {
+      TMATRIX_OP("matrix_norm_inf", sz, 2 * sz * sz, sz * sz * sizeof(T));
+      TDynamicVector<T> s(sz);
+      T* r = s.data();
 
+      parallel_for_range(0, sz, [&](size_t lo, size_t hi)
+      {
+          for (size_t i = lo; i < hi; i++)
+          {
+              const T* a = row(i);
+              r[i] = reduce<T>(0, sz, [a](size_t j) { return abs(a[j]); }, TReduction::Pairwise, REDUCE_BLOCK, false);
+          }
+      }, sz * sz >= PARALLEL_REDUCE_WORK ? ROW_GRAIN : sz);
+      return s.max_value();
+  }
+  // положение первого минимального и максимального элемента (строка, столбец)
+  pair<size_t, size_t> argmin() const
+  {
+      TMATRIX_OP("matrix_argmin", sz, sz * sz, sz * sz * sizeof(T));
+      return arg_extreme_rows([](const T& x, const T& y) { return x < y; });
+  }
+  pair<size_t, size_t> argmax() const
+  {
+      TMATRIX_OP("matrix_argmax", sz, sz * sz, sz * sz * sizeof(T));
+      return arg_extreme_rows([](const T& x, const T& y) { return y < x; });
+  }
+  T min_value() const
+  {
+      pair<size_t, size_t> k = argmin();
+      return row(k.first)[k.second];
+  }
+  T max_value() const
+  {
+      pair<size_t, size_t> k = argmax();
+      return row(k.first)[k.second];
+  }
+
+  // построчные редукции: i-й элемент результата относится к i-й строке
+  TDynamicVector<T> row_sums(TReduction mode = TReduction::Pairwise) const
+  {
+      TMATRIX_OP("matrix_row_sums", sz, sz * sz, (sz * sz + sz) * sizeof(T));
+      TDynamicVector<T> res(sz);
+      T* r = res.data();
+
+      parallel_for_range(0, sz, [&](size_t lo, size_t hi)
+      {
+          for (size_t i = lo; i < hi; i++)
+          {
+              const T* a = row(i);
+              r[i] = reduce<T>(0, sz, [a](size_t j) { return a[j]; }, mode, REDUCE_BLOCK, false);
+          }
+      }, sz * sz >= PARALLEL_REDUCE_WORK ? ROW_GRAIN : sz);
+      return res;
+  }
+  TDynamicVector<T> row_min() const
+  {
+      TMATRIX_OP("matrix_row_min", sz, sz * sz, (sz * sz + sz) * sizeof(T));
+      return row_extreme([](const T& x, const T& y) { return x < y; });
+  }
+  TDynamicVector<T> row_max() const
+  {
+      TMATRIX_OP("matrix_row_max", sz, sz * sz, (sz * sz + sz) * sizeof(T));
+      return row_extreme([](const T& x, const T& y) { return y < x; });
+  }
+  // постолбцовые редукции: проход по строкам, каждый поток ведёт свой
+  // диапазон столбцов, поэтому память читается последовательно
+  TDynamicVector<T> col_sums(TReduction mode = TReduction::Pairwise) const
+  {
+      TMATRIX_OP("matrix_col_sums", sz, sz * sz, (sz * sz + sz) * sizeof(T));
+      return sum_cols(mode, [](const T& a) { return a; });
+  }
+  TDynamicVector<T> col_min() const
+  {
+      TMATRIX_OP("matrix_col_min", sz, sz * sz, (sz * sz + sz) * sizeof(T));
+      return reduce_cols([](const T& a) { return a; },
+          [](const T& acc, const T& a) { return a < acc ? a : acc; });
+  }
+  TDynamicVector<T> col_max() const
+  {
+      TMATRIX_OP("matrix_col_max", sz, sz * sz, (sz * sz + sz) * sizeof(T));
+      return reduce_cols([](const T& a) { return a; },
+          [](const T& acc, const T& a) { return acc < a ? a : acc; });
+  }
 
   // матрично-скалярные операции
   TDynamicMatrix operator*(const T& val)
   {
+      TMATRIX_OP("matrix_mul_scalar", sz, sz * sz, 2 * sz * sz * sizeof(T));
       TDynamicMatrix res(sz);
 
       for (size_t i = 0; i < sz; i++)
@@ -325,9 +1748,72 @@ public:
       return res;
   }
 
+  TDynamicMatrix& operator*=(const T& val)
+  {
+      TMATRIX_OP("matrix_mul_scalar_inplace", sz, sz * sz, 2 * sz * sz * sizeof(T));
+      this->detach();
+      for (size_t i = 0; i < sz; i++)
+      {
+          pMem[i] *= val;
+      }
+      return *this;
+  }
+
+  // поэлементные операции (см. TDynamicVector::map)
+  template<typename F>
+  TDynamicMatrix map(F f) const
+  {
+      TMATRIX_OP("matrix_map", sz, sz * sz, 2 * sz * sz * sizeof(T));
+      TDynamicMatrix res(sz);
+
+      res.for_rows([&](size_t i, T* r) { elementwise_range(r, 0, sz, f, row(i)); });
+      return res;
+  }
+  template<typename F>
+  TDynamicMatrix& apply(F f)
+  {
+      TMATRIX_OP("matrix_apply", sz, sz * sz, 2 * sz * sz * sizeof(T));
+      for_rows([&](size_t, T* r) { elementwise_range(r, 0, sz, f, static_cast<const T*>(r)); });
+      return *this;
+  }
+  template<typename F, typename... M>
+  friend TDynamicMatrix zip(F f, const TDynamicMatrix& a, const M&... rest)
+  {
+      TMATRIX_OP("matrix_zip", a.sz, a.sz * a.sz, (sizeof...(M) + 2) * a.sz * a.sz * sizeof(T));
+      if ((false || ... || (rest.size() != a.sz)))
+      {
+          throw("Error");
+      }
+      TDynamicMatrix res(a.sz);
+
+      res.for_rows([&](size_t i, T* r) { elementwise_range(r, 0, a.sz, f, a.row(i), rest.row(i)...); });
+      return res;
+  }
+  friend TDynamicMatrix hadamard(const TDynamicMatrix& a, const TDynamicMatrix& b)
+  {
+      return zip([](const T& x, const T& y) { return x * y; }, a, b);
+  }
+  friend TDynamicMatrix divide(const TDynamicMatrix& a, const TDynamicMatrix& b)
+  {
+      return zip([](const T& x, const T& y) { return x / y; }, a, b);
+  }
+  friend TDynamicMatrix abs(const TDynamicMatrix& m)
+  {
+      return m.map([](const T& x) { return abs(x); });
+  }
+  friend TDynamicMatrix exp(const TDynamicMatrix& m)
+  {
+      return m.map([](const T& x) { return static_cast<T>(exp(x)); });
+  }
+  friend TDynamicMatrix clamp(const TDynamicMatrix& m, const T& lo, const T& hi)
+  {
+      return m.map([lo, hi](const T& x) { return x < lo ? lo : (hi < x ? hi : x); });
+  }
+
   // матрично-векторные операции
   TDynamicVector<T> operator*(const TDynamicVector<T>& v)
   {
+      TMATRIX_OP("gemv", sz, 2 * sz * sz, (sz * sz + 2 * sz) * sizeof(T));
       if (pMem[0].size() != v.size())
       {
           throw("Error");
@@ -336,17 +1822,149 @@ public:
       {
           TDynamicVector<T> res(sz);
 
-          for (size_t i = 0; i < sz; i++)
+          multiply_to(v, res);
+          return res;
+      }
+  }
+  // x^T * A без построения транспонированной матрицы
+  friend TDynamicVector<T> operator*(const TDynamicVector<T>& x, const TDynamicMatrix& m)
+  {
+      TMATRIX_OP("gemv_transposed", m.sz, 2 * m.sz * m.sz, (m.sz * m.sz + 2 * m.sz) * sizeof(T));
+      TDynamicVector<T> res(m.sz);
+
+      m.transposed_multiply_to(x, res);
+      return res;
+  }
+
+  // строки [lo, hi) произведения A * v: по 4 строки за проход,
+  // каждый загруженный элемент v используется четырежды
+  void multiply_rows(const TDynamicVector<T>& v, TDynamicVector<T>& res, size_t lo, size_t hi) const
+  {
+      const T* x = v.data();
+      T* r = res.data();
+      const size_t blocked = lo + (hi - lo) / 4 * 4;
+      size_t i = lo;
+
+      for (; i < blocked; i += 4)
+      {
+          const T* a0 = row(i);
+          const T* a1 = row(i + 1);
+          const T* a2 = row(i + 2);
+          const T* a3 = row(i + 3);
+          T s0{}, s1{}, s2{}, s3{};
+
+          for (size_t j = 0; j < sz; j++)
           {
-              res[i] = pMem[i] * v;
+              const T xj = x[j];
+              s0 += a0[j] * xj;
+              s1 += a1[j] * xj;
+              s2 += a2[j] * xj;
+              s3 += a3[j] * xj;
           }
-          return res;
+          r[i] = s0;
+          r[i + 1] = s1;
+          r[i + 2] = s2;
+          r[i + 3] = s3;
+      }
+      for (; i < hi; i++)
+      {
+          const T* a = row(i);
+          T s{};
+
+          for (size_t j = 0; j < sz; j++)
+          {
+              s += a[j] * x[j];
+          }
+          r[i] = s;
+      }
+  }
+  // res = A * v без выделения памяти; строки делятся между потоками
+  void multiply_to(const TDynamicVector<T>& v, TDynamicVector<T>& res) const
+  {
+      TMATRIX_OP("gemv", sz, 2 * sz * sz, (sz * sz + 2 * sz) * sizeof(T));
+      if (v.size() != sz)
+      {
+          throw("Error");
+      }
+      if (&res == &v)
+      {
+          throw("Error!The result must not alias an operand");
+      }
+      if (res.size() != sz)
+      {
+          res = TDynamicVector<T>(sz);
+      }
+      res.data();
+      if (sz * sz < PARALLEL_GEMV_WORK)
+      {
+          multiply_rows(v, res, 0, sz);
+      }
+      else
+      {
+          parallel_for_range(0, sz, [&](size_t lo, size_t hi) { multiply_rows(v, res, lo, hi); }, ROW_GRAIN);
+      }
+  }
+  // res = x^T * A: строки A проходятся подряд, потоки делят столбцы
+  void transposed_multiply_to(const TDynamicVector<T>& x, TDynamicVector<T>& res) const
+  {
+      TMATRIX_OP("gemv_transposed", sz, 2 * sz * sz, (sz * sz + 2 * sz) * sizeof(T));
+      if (x.size() != sz)
+      {
+          throw("Error");
+      }
+      if (&res == &x)
+      {
+          throw("Error!The result must not alias an operand");
+      }
+      if (res.size() != sz)
+      {
+          res = TDynamicVector<T>(sz);
+      }
+      T* r = res.data();
+      auto columns = [&](size_t lo, size_t hi)
+      {
+          size_t i = 0;
+
+          std::fill(r + lo, r + hi, T());
+          for (; i + 4 <= sz; i += 4)
+          {
+              const T x0 = x[i], x1 = x[i + 1], x2 = x[i + 2], x3 = x[i + 3];
+              const T* a0 = row(i);
+              const T* a1 = row(i + 1);
+              const T* a2 = row(i + 2);
+              const T* a3 = row(i + 3);
+
+              for (size_t j = lo; j < hi; j++)
+              {
+                  r[j] += x0 * a0[j] + x1 * a1[j] + x2 * a2[j] + x3 * a3[j];
+              }
+          }
+          for (; i < sz; i++)
+          {
+              const T xi = x[i];
+              const T* a = row(i);
+
+              for (size_t j = lo; j < hi; j++)
+              {
+                  r[j] += xi * a[j];
+              }
+          }
+      };
+      if (sz * sz < PARALLEL_GEMV_WORK)
+      {
+          columns(0, sz);
+      }
+      else
+      {
+          // границы по 64 элемента, чтобы потоки не делили строки кэша
+          parallel_for_range(0, sz, columns, 64);
       }
   }
 
   // матрично-матричные операции
   TDynamicMatrix operator+(const TDynamicMatrix& m)
   {
+      TMATRIX_OP("matrix_add", sz, sz * sz, 3 * sz * sz * sizeof(T));
       if (sz != m.size())
       {
           throw("Error");
@@ -361,6 +1979,7 @@ public:
   }
   TDynamicMatrix operator-(const TDynamicMatrix& m)
   {
+      TMATRIX_OP("matrix_sub", sz, sz * sz, 3 * sz * sz * sizeof(T));
       if (sz != m.size())
       {
           throw("Error");
@@ -377,38 +1996,226 @@ public:
       }
       
   }
+  TDynamicMatrix& operator+=(const TDynamicMatrix& m)
+  {
+      TMATRIX_OP("matrix_add_inplace", sz, sz * sz, 3 * sz * sz * sizeof(T));
+      if (sz != m.sz)
+      {
+          throw("Error");
+      }
+      this->detach();
+      for (size_t i = 0; i < sz; i++)
+      {
+          pMem[i] += m.pMem[i];
+      }
+      return *this;
+  }
+  TDynamicMatrix& operator-=(const TDynamicMatrix& m)
+  {
+      TMATRIX_OP("matrix_sub_inplace", sz, sz * sz, 3 * sz * sz * sizeof(T));
+      if (sz != m.sz)
+      {
+          throw("Error");
+      }
+      this->detach();
+      for (size_t i = 0; i < sz; i++)
+      {
+          pMem[i] -= m.pMem[i];
+      }
+      return *this;
+  }
+  // this += a * m за один проход
+  TDynamicMatrix& axpy(const T& a, const TDynamicMatrix& m)
+  {
+      TMATRIX_OP("matrix_axpy", sz, 2 * sz * sz, 3 * sz * sz * sizeof(T));
+      if (sz != m.sz)
+      {
+          throw("Error");
+      }
+      this->detach();
+      for (size_t i = 0; i < sz; i++)
+      {
+          pMem[i].axpy(a, m.pMem[i]);
+      }
+      return *this;
+  }
   TDynamicMatrix operator*(const TDynamicMatrix& m)
   {
+      TMATRIX_OP("gemm", sz, 2 * sz * sz * sz, 3 * sz * sz * sizeof(T));
       if (sz != m.size())
       {
           throw("Error");
       }
-      
+      TDynamicMatrix<T> res(sz);
+
+      multiply_to(m, res);
+      return res;
+  }
+
+  // строки [lo, hi) произведения (*this) * m в готовую матрицу res;
+  // порядок i-k-j: строки m читаются подряд, внутренний цикл векторизуется
+  void multiply_rows(const TDynamicMatrix& m, TDynamicMatrix& res, size_t lo, size_t hi) const
+  {
+      res.detach();
+      for (size_t i = lo; i < hi; i++)
+      {
+          T* r = res.pMem[i].data();
+          const T* a = row(i);
+
+          std::fill(r, r + sz, T());
+          for (size_t k = 0; k < sz; k++)
+          {
+              const T aik = a[k];
+              const T* b = m.row(k);
+
+              for (size_t j = 0; j < sz; j++)
+              {
+                  r[j] += aik * b[j];
+              }
+          }
+      }
+  }
+  // произведение без выделения памяти под результат;
+  // res не должна совпадать с операндами
+  void multiply_to(const TDynamicMatrix& m, TDynamicMatrix& res) const
+  {
+      TMATRIX_OP("gemm", sz, 2 * sz * sz * sz, 3 * sz * sz * sizeof(T));
+      if (sz != m.sz)
+      {
+          throw("Error");
+      }
+      if (&res == this || &res == &m)
+      {
+          throw("Error!The result must not alias an operand");
+      }
+      if (res.sz != sz)
+      {
+          res = TDynamicMatrix(sz);
+      }
+      // разделяемые буферы результата отделяются до запуска потоков
+      res.detach();
+      for (size_t i = 0; i < sz; i++)
+      {
+          res.pMem[i].data();
+      }
+      if (sz * sz * sz < PARALLEL_GEMM_WORK)
+      {
+          multiply_rows(m, res, 0, sz);
+      }
       else
       {
-          TDynamicMatrix<T> res(sz);
+          parallel_for_range(0, sz, [&](size_t lo, size_t hi) { multiply_rows(m, res, lo, hi); }, ROW_GRAIN);
+      }
+  }
 
-          TDynamicVector<T> tmp(pMem[0].size());
+  // строки [lo, hi) произведения по модулю (элементы в [0, mod), mod <= 2^32):
+  // строка копится в 64-битных суммах без редукции, пока помещаются
+  // lazy_terms произведений, затем один раз редуцируется по Барретту
+  void multiply_mod_rows(const TDynamicMatrix& m, TDynamicMatrix& res, const TBarrett& q, size_t lo, size_t hi) const
+  {
+      const size_t lazy = min(q.lazy_terms(), sz);
+      vector<uint64_t> acc(sz);
+      uint64_t* c = acc.data();
 
-          for (size_t i = 0; i < sz; i++)
+      res.detach();
+      for (size_t i = lo; i < hi; i++)
+      {
+          const T* a = row(i);
+
+          std::fill(c, c + sz, uint64_t(0));
+          for (size_t k0 = 0; k0 < sz; k0 += lazy)
           {
-              for (size_t j = 0; j < pMem[0].size(); j++)
+              const size_t k1 = min(sz, k0 + lazy);
+
+              for (size_t k = k0; k < k1; k++)
               {
-                  for (size_t k = 0; k < pMem[0].size(); k++)
+                  const uint64_t aik = static_cast<uint64_t>(a[k]);
+                  const T* b = m.row(k);
+
+                  if (aik == 0)
+                  {
+                      continue;
+                  }
+                  for (size_t j = 0; j < sz; j++)
                   {
-                      tmp[k] = m.pMem[k][j];
+                      c[j] += aik * static_cast<uint64_t>(b[j]);
                   }
-                  res[i][j] = pMem[i] * tmp;
+              }
+              for (size_t j = 0; j < sz; j++)
+              {
+                  c[j] = q.reduce(c[j]);
               }
           }
-          return res;
+          T* r = res.pMem[i].data();
+          for (size_t j = 0; j < sz; j++)
+          {
+              r[j] = static_cast<T>(c[j]);
+          }
       }
-      
+  }
+  // произведение по модулю для целых T без выделения памяти под результат;
+  // элементы операндов должны лежать в [0, mod)
+  void multiply_mod_to(const TDynamicMatrix& m, TDynamicMatrix& res, T mod) const
+  {
+      static_assert(is_integral<T>::value, "modular product requires an integer type");
+      TMATRIX_OP("gemm_mod", sz, 2 * sz * sz * sz, 3 * sz * sz * sizeof(T));
+      if (sz != m.sz)
+      {
+          throw("Error");
+      }
+      if (mod < 2 || static_cast<uint64_t>(mod) > (uint64_t(1) << 32))
+      {
+          throw("Error!Invalid modulus");
+      }
+      if (&res == this || &res == &m)
+      {
+          throw("Error!The result must not alias an operand");
+      }
+      if (res.sz != sz)
+      {
+          res = TDynamicMatrix(sz);
+      }
+      res.detach();
+      for (size_t i = 0; i < sz; i++)
+      {
+          res.pMem[i].data();
+      }
+      const TBarrett q(static_cast<uint64_t>(mod));
+
+      parallel_for_range(0, sz, [&](size_t lo, size_t hi) { multiply_mod_rows(m, res, q, lo, hi); },
+          sz * sz * sz < PARALLEL_GEMM_WORK ? sz : ROW_GRAIN);
+  }
+
+  // A^k двоичным возведением в степень: результат, основание и одна рабочая
+  // матрица выделяются один раз, дальше произведения пишутся в рабочую
+  // матрицу и меняются с ней местами (A^0 - единичная матрица)
+  friend TDynamicMatrix pow(const TDynamicMatrix& a, unsigned long long k)
+  {
+      return a.power(k, [](const TDynamicMatrix& x, const TDynamicMatrix& y, TDynamicMatrix& r) { x.multiply_to(y, r); },
+          [](const T& x) { return x; });
+  }
+  // A^k по модулю mod для целых T; элементы A приводятся в [0, mod)
+  friend TDynamicMatrix pow_mod(const TDynamicMatrix& a, unsigned long long k, T mod)
+  {
+      static_assert(is_integral<T>::value, "modular power requires an integer type");
+      if (mod < 2 || static_cast<uint64_t>(mod) > (uint64_t(1) << 32))
+      {
+          throw("Error!Invalid modulus");
+      }
+      return a.power(k, [mod](const TDynamicMatrix& x, const TDynamicMatrix& y, TDynamicMatrix& r)
+      {
+          x.multiply_mod_to(y, r, mod);
+      }, [mod](const T& x)
+      {
+          const T y = x % mod;
+          return y < 0 ? T(y + mod) : y;
+      });
   }
 
   // ввод/вывод
   friend istream& operator>>(istream& istr, TDynamicMatrix& v)
   {
+      v.detach();
       for (size_t i = 0; i < v.sz; i++)
       {
           istr >> v.pMem[i];
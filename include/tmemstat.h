@@ -0,0 +1,261 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Учёт памяти векторов и матриц
+//
+// При сборке с TMATRIX_TRACK_MEMORY каждое выделение и освобождение буфера
+// TDynamicVector/TDynamicMatrix учитывается глобально и по потокам: живые
+// байты, пик, число выделений и гистограмма размеров (корзина floor(log2)).
+// TMemoryScope измеряет пик внутри этапа обработки, включая выделения
+// рабочих потоков. Без TMATRIX_TRACK_MEMORY макросы учёта пусты.
+// Потоковая статистика - это баланс выделений и освобождений самого потока,
+// она может быть отрицательной, если поток освобождает чужие буферы.
+
+#ifndef __TMemStat_H__
+#define __TMemStat_H__
+
+#ifdef TMATRIX_TRACK_MEMORY
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+const int MEMSTAT_BUCKETS = 64;
+
+// Снимок статистики
+struct TMemoryStats
+{
+  int64_t liveBytes = 0;
+  int64_t peakBytes = 0;
+  uint64_t allocations = 0;
+  uint64_t deallocations = 0;
+  uint64_t histogram[MEMSTAT_BUCKETS] = {};  // число выделений по корзинам размера
+};
+
+class TMemoryScope;
+
+// Общие счётчики
+class TMemoryTracker
+{
+  friend class TMemoryScope;
+
+  atomic<int64_t> live{ 0 };
+  atomic<int64_t> peak{ 0 };
+  atomic<uint64_t> allocs{ 0 };
+  atomic<uint64_t> frees{ 0 };
+  atomic<uint64_t> hist[MEMSTAT_BUCKETS];
+  atomic<int> activeScopes{ 0 };
+  mutex scopeMtx;
+  vector<TMemoryScope*> scopes;
+
+  struct TStage
+  {
+    uint64_t runs = 0;
+    int64_t maxPeak = 0;
+    uint64_t allocations = 0;
+  };
+  map<string, TStage> stages;
+
+  static TMemoryStats& local()
+  {
+    thread_local TMemoryStats st;
+    return st;
+  }
+  static void raise(atomic<int64_t>& target, int64_t value)
+  {
+    int64_t cur = target.load(memory_order_relaxed);
+    while (cur < value && !target.compare_exchange_weak(cur, value, memory_order_relaxed))
+    {
+    }
+  }
+  void update_scopes(int64_t nowLive, bool allocation, uint64_t bytes);
+public:
+  TMemoryTracker()
+  {
+    for (auto& h : hist)
+      h = 0;
+  }
+  static TMemoryTracker& instance()
+  {
+    static TMemoryTracker tracker;
+    return tracker;
+  }
+  static int bucket(size_t bytes) noexcept
+  {
+    int b = 0;
+    while (bytes > 1 && b < MEMSTAT_BUCKETS - 1)
+    {
+      bytes >>= 1;
+      b++;
+    }
+    return b;
+  }
+
+  void on_allocate(size_t bytes)
+  {
+    const int64_t nowLive = live.fetch_add(static_cast<int64_t>(bytes), memory_order_relaxed) + static_cast<int64_t>(bytes);
+    raise(peak, nowLive);
+    allocs.fetch_add(1, memory_order_relaxed);
+    hist[bucket(bytes)].fetch_add(1, memory_order_relaxed);
+
+    TMemoryStats& st = local();
+    st.liveBytes += bytes;
+    st.peakBytes = max(st.peakBytes, st.liveBytes);
+    st.allocations++;
+    st.histogram[bucket(bytes)]++;
+
+    if (activeScopes.load(memory_order_acquire) > 0)
+      update_scopes(nowLive, true, bytes);
+  }
+  void on_deallocate(size_t bytes)
+  {
+    live.fetch_sub(static_cast<int64_t>(bytes), memory_order_relaxed);
+    frees.fetch_add(1, memory_order_relaxed);
+
+    TMemoryStats& st = local();
+    st.liveBytes -= bytes;
+    st.deallocations++;
+  }
+
+  TMemoryStats global_stats() const
+  {
+    TMemoryStats st;
+    st.liveBytes = live.load();
+    st.peakBytes = peak.load();
+    st.allocations = allocs.load();
+    st.deallocations = frees.load();
+    for (int b = 0; b < MEMSTAT_BUCKETS; b++)
+      st.histogram[b] = hist[b].load();
+    return st;
+  }
+  TMemoryStats thread_stats() const { return local(); }
+
+  // пик снова отсчитывается от текущего объёма
+  void reset_peak()
+  {
+    peak = live.load();
+    local().peakBytes = local().liveBytes;
+  }
+
+  void attach(TMemoryScope* s);
+  void detach(TMemoryScope* s);
+
+  // сводка по этапам: число запусков, наибольший пик сверх начального объёма
+  void stage_report(ostream& os)
+  {
+    lock_guard<mutex> guard(scopeMtx);
+    os << "stage,runs,max_peak_bytes,allocations\n";
+    for (const auto& item : stages)
+      os << item.first << ',' << item.second.runs << ',' << item.second.maxPeak << ','
+        << item.second.allocations << '\n';
+  }
+  void reset_stages()
+  {
+    lock_guard<mutex> guard(scopeMtx);
+    stages.clear();
+  }
+};
+
+// Этап обработки: пик живой памяти (всех потоков) относительно начала этапа
+class TMemoryScope
+{
+  friend class TMemoryTracker;
+
+  string stage;
+  int64_t base;
+  int64_t peakLive;
+  uint64_t allocs = 0;
+  uint64_t allocBytes = 0;
+public:
+  explicit TMemoryScope(const string& name) : stage(name)
+  {
+    TMemoryTracker::instance().attach(this);
+  }
+  ~TMemoryScope()
+  {
+    TMemoryTracker::instance().detach(this);
+  }
+  TMemoryScope(const TMemoryScope&) = delete;
+  TMemoryScope& operator=(const TMemoryScope&) = delete;
+
+  const string& name() const noexcept { return stage; }
+  // наибольший прирост живой памяти с начала этапа
+  int64_t peak_bytes() const;
+  // число и суммарный размер выделений за этап
+  uint64_t allocations() const;
+  uint64_t allocated_bytes() const;
+};
+
+inline void TMemoryTracker::update_scopes(int64_t nowLive, bool allocation, uint64_t bytes)
+{
+  lock_guard<mutex> guard(scopeMtx);
+  for (TMemoryScope* s : scopes)
+  {
+    s->peakLive = max(s->peakLive, nowLive);
+    if (allocation)
+    {
+      s->allocs++;
+      s->allocBytes += bytes;
+    }
+  }
+}
+inline void TMemoryTracker::attach(TMemoryScope* s)
+{
+  lock_guard<mutex> guard(scopeMtx);
+  s->base = live.load();
+  s->peakLive = s->base;
+  scopes.push_back(s);
+  activeScopes.fetch_add(1, memory_order_release);
+}
+inline void TMemoryTracker::detach(TMemoryScope* s)
+{
+  lock_guard<mutex> guard(scopeMtx);
+  scopes.erase(find(scopes.begin(), scopes.end(), s));
+  activeScopes.fetch_sub(1, memory_order_release);
+  TStage& st = stages[s->stage];
+  st.runs++;
+  st.maxPeak = max(st.maxPeak, s->peakLive - s->base);
+  st.allocations += s->allocs;
+}
+
+inline int64_t TMemoryScope::peak_bytes() const
+{
+  TMemoryTracker& t = TMemoryTracker::instance();
+  lock_guard<mutex> guard(t.scopeMtx);
+  return peakLive - base;
+}
+inline uint64_t TMemoryScope::allocations() const
+{
+  TMemoryTracker& t = TMemoryTracker::instance();
+  lock_guard<mutex> guard(t.scopeMtx);
+  return allocs;
+}
+inline uint64_t TMemoryScope::allocated_bytes() const
+{
+  TMemoryTracker& t = TMemoryTracker::instance();
+  lock_guard<mutex> guard(t.scopeMtx);
+  return allocBytes;
+}
+
+inline TMemoryStats memory_stats() { return TMemoryTracker::instance().global_stats(); }
+inline TMemoryStats thread_memory_stats() { return TMemoryTracker::instance().thread_stats(); }
+inline void memory_reset_peak() { TMemoryTracker::instance().reset_peak(); }
+inline void memory_stage_report(ostream& os) { TMemoryTracker::instance().stage_report(os); }
+
+#define TMATRIX_TRACK_ALLOC(bytes) TMemoryTracker::instance().on_allocate(bytes)
+#define TMATRIX_TRACK_FREE(bytes) TMemoryTracker::instance().on_deallocate(bytes)
+
+#else
+
+#define TMATRIX_TRACK_ALLOC(bytes)
+#define TMATRIX_TRACK_FREE(bytes)
+
+#endif
+
+#endif
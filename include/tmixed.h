@@ -0,0 +1,226 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Смешанная точность: хранение в узком типе, накопление в широком
+//
+// Матрицы хранятся в float (или bfloat16), произведения накапливаются в
+// double (float): вдвое меньше памяти и трафика при той же точности сумм.
+// Линейные системы решаются итерационным уточнением: LU-разложение в
+// низкой точности, невязка и поправки - в высокой.
+
+#ifndef __TMixed_H__
+#define __TMixed_H__
+
+#include <cstring>
+#include "tsolvers.h"
+
+// bfloat16 - старшие 16 бит float (тот же порядок, 7 бит мантиссы);
+// только для хранения, арифметика идёт через float
+struct TBFloat16
+{
+  uint16_t bits;
+
+  TBFloat16() : bits(0) {}
+  TBFloat16(float f)
+  {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    if ((u & 0x7fffffffu) > 0x7f800000u)
+      bits = static_cast<uint16_t>((u >> 16) | 0x40u);  // NaN остаётся NaN
+    else
+      bits = static_cast<uint16_t>((u + 0x7fffu + ((u >> 16) & 1)) >> 16);  // к ближайшему чётному
+  }
+  operator float() const
+  {
+    const uint32_t u = static_cast<uint32_t>(bits) << 16;
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+  }
+};
+template<> struct TWideAccumulator<TBFloat16> { using type = float; };
+
+// порог работы, начиная с которого строки делятся между потоками
+const size_t PARALLEL_MIXED_WORK = 1 << 18;
+
+// y = A * x: A и x хранятся в T, суммы и результат - в Acc
+template<typename T, typename Acc = typename TWideAccumulator<T>::type>
+void mixed_multiply_to(const TDynamicMatrix<T>& a, const TDynamicVector<T>& x, TDynamicVector<Acc>& y)
+{
+  const size_t n = a.size();
+
+  TMATRIX_OP("gemv_mixed", n, 2 * n * n, (n * n + n) * sizeof(T) + n * sizeof(Acc));
+  if (x.size() != n)
+    throw("Error");
+  if (y.size() != n)
+    y = TDynamicVector<Acc>(n);
+  const T* v = x.data();
+  Acc* r = y.data();
+
+  parallel_for_range(0, n, [&](size_t lo, size_t hi)
+  {
+    for (size_t i = lo; i < hi; i++)
+    {
+      const T* ai = a[i].data();
+      r[i] = reduce_lanes<Acc>(0, n, [ai, v](size_t j) { return Acc(ai[j]) * Acc(v[j]); });
+    }
+  }, n * n < PARALLEL_MIXED_WORK ? n : ROW_GRAIN);
+}
+
+// C = A * B: строка C накапливается в Acc (порядок i-k-j)
+template<typename T, typename Acc = typename TWideAccumulator<T>::type>
+void mixed_multiply_to(const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b, TDynamicMatrix<Acc>& c)
+{
+  const size_t n = a.size();
+
+  TMATRIX_OP("gemm_mixed", n, 2 * n * n * n, 2 * n * n * sizeof(T) + n * n * sizeof(Acc));
+  if (b.size() != n)
+    throw("Error");
+  if (static_cast<const void*>(&c) == &a || static_cast<const void*>(&c) == &b)
+    throw("Error!The result must not alias an operand");
+  if (c.size() != n)
+    c = TDynamicMatrix<Acc>(n);
+  // разделяемые буферы результата отделяются до запуска потоков
+  for (size_t i = 0; i < n; i++)
+    c[i].data();
+  parallel_for_range(0, n, [&](size_t lo, size_t hi)
+  {
+    for (size_t i = lo; i < hi; i++)
+    {
+      Acc* r = c[i].data();
+      const T* ai = a[i].data();
+
+      std::fill(r, r + n, Acc());
+      for (size_t k = 0; k < n; k++)
+      {
+        const Acc aik = Acc(ai[k]);
+        const T* bk = b[k].data();
+        for (size_t j = 0; j < n; j++)
+          r[j] += aik * Acc(bk[j]);
+      }
+    }
+  }, n * n * n < PARALLEL_MIXED_WORK * 8 ? n : ROW_GRAIN);
+}
+
+// LU-разложение с выбором главного элемента по столбцу, хранимое в Low
+template<typename Low>
+class TLUFactor
+{
+protected:
+  size_t n;
+  vector<Low> lu;       // L (единичная диагональ не хранится) и U, по строкам
+  vector<size_t> perm;  // perm[i] - исходная строка, ставшая i-й
+public:
+  template<typename T>
+  explicit TLUFactor(const TDynamicMatrix<T>& a) : n(a.size()), lu(n * n), perm(n)
+  {
+    TMATRIX_OP("lu_factor", n, 2 * n * n * n / 3, n * n * sizeof(Low));
+    for (size_t i = 0; i < n; i++)
+    {
+      const T* r = a[i].data();
+      for (size_t j = 0; j < n; j++)
+        lu[i * n + j] = static_cast<Low>(r[j]);
+      perm[i] = i;
+    }
+    for (size_t c = 0; c < n; c++)
+    {
+      size_t piv = c;
+      for (size_t i = c + 1; i < n; i++)
+        if (abs(lu[i * n + c]) > abs(lu[piv * n + c]))
+          piv = i;
+      if (lu[piv * n + c] == Low(0))
+        throw("Error!Matrix is singular");
+      if (piv != c)
+      {
+        swap_ranges(lu.begin() + piv * n, lu.begin() + piv * n + n, lu.begin() + c * n);
+        swap(perm[piv], perm[c]);
+      }
+      const Low* top = lu.data() + c * n;
+      const Low inv = Low(1) / top[c];
+      // строки ниже опорной независимы и делятся между потоками
+      parallel_for_range(c + 1, n, [&](size_t lo, size_t hi)
+      {
+        for (size_t i = lo; i < hi; i++)
+        {
+          Low* r = lu.data() + i * n;
+          const Low f = r[c] * inv;
+          r[c] = f;
+          for (size_t j = c + 1; j < n; j++)
+            r[j] -= f * top[j];
+        }
+      }, (n - c) * (n - c) < PARALLEL_MIXED_WORK ? n : ROW_GRAIN);
+    }
+  }
+
+  size_t size() const noexcept { return n; }
+
+  // x = A^-1 * b (b и x могут быть одним вектором)
+  void solve(const TDynamicVector<Low>& b, TDynamicVector<Low>& x) const
+  {
+    if (b.size() != n)
+      throw("Error!The lengths of the vectors are not equal");
+    vector<Low> y(n);
+    const Low* pb = b.data();
+
+    for (size_t i = 0; i < n; i++)
+    {
+      const Low* r = lu.data() + i * n;
+      Low s = pb[perm[i]];
+      for (size_t j = 0; j < i; j++)
+        s -= r[j] * y[j];
+      y[i] = s;
+    }
+    for (size_t i = n; i-- > 0;)
+    {
+      const Low* r = lu.data() + i * n;
+      Low s = y[i];
+      for (size_t j = i + 1; j < n; j++)
+        s -= r[j] * y[j];
+      y[i] = s / r[i];
+    }
+    if (x.size() != n)
+      x = TDynamicVector<Low>(n);
+    std::copy(y.begin(), y.end(), x.data());
+  }
+};
+
+// Итерационное уточнение: A раскладывается один раз в Low (O(n^3) в низкой
+// точности), далее на каждой итерации r = b - A*x считается в T, поправка
+// d = LU^-1 * r - в Low, x += d. Сходится к точности T, если A не слишком
+// плохо обусловлена для Low; при застое невязки (итерация уменьшила её
+// меньше чем в 1 / stall раз) возвращает converged = false. Множитель
+// сходимости близок к cond(A) * eps(Low), поэтому stall берётся близким к 1.
+template<typename Low = float, typename T>
+TSolverResult refine_solve(const TDynamicMatrix<T>& a, const TDynamicVector<T>& b, TDynamicVector<T>& x,
+  size_t maxIter = 20, double tol = 1e-12, double stall = 0.9)
+{
+  const size_t n = b.size();
+  if (a.size() != n || x.size() != n)
+    throw("Error!The lengths of the vectors are not equal");
+  const TLUFactor<Low> lu(a);
+  TDynamicVector<T> r(n), ax(n);
+  TDynamicVector<Low> d(n);
+  const double bnorm = max(norm2(b), 1e-300);
+
+  residual_to(a, b, x, ax, r);
+  double res = norm2(r) / bnorm;
+  if (res <= tol)
+    return { 0, res, true };
+  for (size_t it = 1; it <= maxIter; it++)
+  {
+    for (size_t i = 0; i < n; i++)
+      d[i] = static_cast<Low>(r[i]);
+    lu.solve(d, d);
+    for (size_t i = 0; i < n; i++)
+      x[i] += static_cast<T>(d[i]);
+    residual_to(a, b, x, ax, r);
+    const double prev = res;
+    res = norm2(r) / bnorm;
+    if (res <= tol)
+      return { it, res, true };
+    if (res > stall * prev)
+      return { it, res, false };
+  }
+  return { maxIter, res, false };
+}
+
+#endif
@@ -0,0 +1,410 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Профилирование операций tmatrix.h аппаратными счётчиками
+//
+// При сборке с TMATRIX_PROFILE каждая открытая операция векторов и матриц
+// замеряет время и счётчики perf_event_open (такты, инструкции, промахи LLC
+// и dTLB), результаты копятся по имени операции и размерной корзине
+// (floor(log2(n))). Вместе с ними аналитически учитываются число операций
+// с плавающей точкой и минимальный объём пересылаемых данных, что позволяет
+// поставить каждое ядро на roofline-диаграмму машины.
+// Без TMATRIX_PROFILE макрос TMATRIX_PROFILE_OP пуст.
+// Учитывается только внешняя операция: вложенные вызовы, в том числе
+// в рабочих потоках parallel_for_range, не считаются повторно.
+
+#ifndef __TProfile_H__
+#define __TProfile_H__
+
+#ifdef TMATRIX_PROFILE
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Аппаратные события профиля
+enum TPerfEvent { PERF_CYCLES, PERF_INSTRUCTIONS, PERF_LLC_MISSES, PERF_DTLB_MISSES, PERF_EVENT_COUNT };
+
+// Накопленные показатели одной операции в одной корзине размеров
+struct TOpStats
+{
+  uint64_t calls = 0;
+  uint64_t nanoseconds = 0;
+  uint64_t flops = 0;          // операции с плавающей точкой (по размерам)
+  uint64_t bytes = 0;          // минимальный обмен с памятью (по размерам)
+  uint64_t events[PERF_EVENT_COUNT] = {};
+  bool available[PERF_EVENT_COUNT] = {};
+};
+
+// Счётчики текущего потока; открываются при первом использовании.
+// inherit = 1: учитываются и рабочие потоки, запущенные внутри операции
+class TPerfCounters
+{
+  int fd[PERF_EVENT_COUNT];
+public:
+  TPerfCounters()
+  {
+    for (int e = 0; e < PERF_EVENT_COUNT; e++)
+      fd[e] = open_event(e);
+  }
+  ~TPerfCounters()
+  {
+#ifdef __linux__
+    for (int e = 0; e < PERF_EVENT_COUNT; e++)
+      if (fd[e] >= 0)
+        close(fd[e]);
+#endif
+  }
+  TPerfCounters(const TPerfCounters&) = delete;
+  TPerfCounters& operator=(const TPerfCounters&) = delete;
+
+  bool available(int e) const noexcept { return fd[e] >= 0; }
+  uint64_t read_event(int e) const noexcept
+  {
+    uint64_t value = 0;
+#ifdef __linux__
+    if (fd[e] >= 0 && read(fd[e], &value, sizeof(value)) != sizeof(value))
+      value = 0;
+#endif
+    return value;
+  }
+
+  static TPerfCounters& local()
+  {
+    thread_local TPerfCounters counters;
+    return counters;
+  }
+private:
+  static int open_event(int e)
+  {
+#ifdef __linux__
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.inherit = 1;
+    switch (e)
+    {
+    case PERF_CYCLES:
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = PERF_COUNT_HW_CPU_CYCLES;
+      break;
+    case PERF_INSTRUCTIONS:
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+      break;
+    case PERF_LLC_MISSES:
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = PERF_COUNT_HW_CACHE_MISSES;
+      break;
+    default:
+      attr.type = PERF_TYPE_HW_CACHE;
+      attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+      break;
+    }
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+    (void)e;
+    return -1;
+#endif
+  }
+};
+
+// Общая таблица показателей
+class TProfileRegistry
+{
+  mutex mtx;
+  map<pair<string, size_t>, TOpStats> table;
+public:
+  static TProfileRegistry& instance()
+  {
+    static TProfileRegistry registry;
+    return registry;
+  }
+
+  void add(const char* op, size_t bucket, uint64_t ns, uint64_t flops, uint64_t bytes,
+    const uint64_t* events, const bool* available)
+  {
+    lock_guard<mutex> guard(mtx);
+    TOpStats& st = table[make_pair(string(op), bucket)];
+    st.calls++;
+    st.nanoseconds += ns;
+    st.flops += flops;
+    st.bytes += bytes;
+    for (int e = 0; e < PERF_EVENT_COUNT; e++)
+    {
+      st.events[e] += events[e];
+      st.available[e] = available[e];
+    }
+  }
+  map<pair<string, size_t>, TOpStats> snapshot()
+  {
+    lock_guard<mutex> guard(mtx);
+    return table;
+  }
+  void reset()
+  {
+    lock_guard<mutex> guard(mtx);
+    table.clear();
+  }
+};
+
+// корзина размеров: floor(log2(n))
+inline size_t profile_bucket(size_t n) noexcept
+{
+  size_t b = 0;
+  while (n > 1)
+  {
+    n >>= 1;
+    b++;
+  }
+  return b;
+}
+
+// Глубина вложенности замеряемых операций в текущем потоке
+inline int& profile_depth()
+{
+  thread_local int d = 0;
+  return d;
+}
+
+// Рабочий поток parallel_for_range продолжает глубину запустившего его
+// потока (RAII): операции внутри параллельного блока вложены во внешнюю
+// и не записываются (и не открывают счётчики) повторно
+class TProfileNesting
+{
+  int saved;
+public:
+  explicit TProfileNesting(int d) : saved(profile_depth()) { profile_depth() = d; }
+  ~TProfileNesting() { profile_depth() = saved; }
+  TProfileNesting(const TProfileNesting&) = delete;
+  TProfileNesting& operator=(const TProfileNesting&) = delete;
+};
+
+// Замер одной операции (RAII)
+class TOpScope
+{
+  const char* op;
+  size_t n;
+  uint64_t flops;
+  uint64_t bytes;
+  bool outer;
+  uint64_t start[PERF_EVENT_COUNT];
+  chrono::steady_clock::time_point t0;
+
+  static int& depth() { return profile_depth(); }
+public:
+  TOpScope(const char* name, size_t size, uint64_t flopCount, uint64_t byteCount)
+    : op(name), n(size), flops(flopCount), bytes(byteCount), outer(depth()++ == 0)
+  {
+    if (!outer)
+      return;
+    TPerfCounters& pc = TPerfCounters::local();
+    for (int e = 0; e < PERF_EVENT_COUNT; e++)
+      start[e] = pc.read_event(e);
+    t0 = chrono::steady_clock::now();
+  }
+  ~TOpScope()
+  {
+    depth()--;
+    if (!outer)
+      return;
+    auto t1 = chrono::steady_clock::now();
+    TPerfCounters& pc = TPerfCounters::local();
+    uint64_t delta[PERF_EVENT_COUNT];
+    bool available[PERF_EVENT_COUNT];
+    for (int e = 0; e < PERF_EVENT_COUNT; e++)
+    {
+      available[e] = pc.available(e);
+      delta[e] = pc.read_event(e) - start[e];
+    }
+    uint64_t ns = static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(t1 - t0).count());
+    TProfileRegistry::instance().add(op, profile_bucket(n), ns, flops, bytes, delta, available);
+  }
+  TOpScope(const TOpScope&) = delete;
+  TOpScope& operator=(const TOpScope&) = delete;
+};
+
+inline const char* profile_event_name(int e)
+{
+  static const char* names[PERF_EVENT_COUNT] = { "cycles", "instructions", "llc_misses", "dtlb_misses" };
+  return names[e];
+}
+
+inline void profile_reset()
+{
+  TProfileRegistry::instance().reset();
+}
+
+// Отчёт: массив записей {op, bucket, min_size, calls, ns, cycles, ...};
+// недоступный счётчик выводится как null
+inline void profile_report_json(ostream& os)
+{
+  auto table = TProfileRegistry::instance().snapshot();
+  bool first = true;
+  os << "[";
+  for (const auto& item : table)
+  {
+    const TOpStats& st = item.second;
+    os << (first ? "\n" : ",\n") << "  {\"op\": \"" << item.first.first << "\", \"bucket\": " << item.first.second
+      << ", \"min_size\": " << (size_t(1) << item.first.second) << ", \"calls\": " << st.calls
+      << ", \"ns\": " << st.nanoseconds << ", \"flops\": " << st.flops << ", \"bytes\": " << st.bytes;
+    for (int e = 0; e < PERF_EVENT_COUNT; e++)
+    {
+      os << ", \"" << profile_event_name(e) << "\": ";
+      if (st.available[e])
+        os << st.events[e];
+      else
+        os << "null";
+    }
+    os << "}";
+    first = false;
+  }
+  os << "\n]\n";
+}
+// Отчёт CSV; недоступный счётчик - пустое поле
+inline void profile_report_csv(ostream& os)
+{
+  auto table = TProfileRegistry::instance().snapshot();
+  os << "op,bucket,min_size,calls,ns,flops,bytes";
+  for (int e = 0; e < PERF_EVENT_COUNT; e++)
+    os << ',' << profile_event_name(e);
+  os << '\n';
+  for (const auto& item : table)
+  {
+    const TOpStats& st = item.second;
+    os << item.first.first << ',' << item.first.second << ',' << (size_t(1) << item.first.second) << ','
+      << st.calls << ',' << st.nanoseconds << ',' << st.flops << ',' << st.bytes;
+    for (int e = 0; e < PERF_EVENT_COUNT; e++)
+    {
+      os << ',';
+      if (st.available[e])
+        os << st.events[e];
+    }
+    os << '\n';
+  }
+}
+
+// Характеристики машины для roofline: пиковая производительность
+// и пропускная способность памяти
+struct TMachineRoofline
+{
+  double peakGflops;
+  double bandwidthGBs;
+};
+
+// Замер характеристик на текущем числе потоков: пик - независимые цепочки
+// умножения-сложения в регистрах, полоса - триада STREAM на буферах,
+// превышающих кэш (bytes - суммарный объём трёх массивов)
+inline TMachineRoofline measure_machine_roofline(size_t bytes = size_t(192) << 20)
+{
+  const size_t threads = max<size_t>(1, thread::hardware_concurrency());
+  TMachineRoofline r;
+
+  // пик: 16 независимых аккумуляторов на поток
+  {
+    const size_t iters = size_t(1) << 24;
+    vector<double> sink(threads);
+    auto t0 = chrono::steady_clock::now();
+    vector<thread> pool;
+    for (size_t t = 0; t < threads; t++)
+      pool.emplace_back([&sink, t, iters]()
+      {
+        double acc[16];
+        for (int k = 0; k < 16; k++)
+          acc[k] = 1.0 + k * 1e-3;
+        for (size_t i = 0; i < iters; i++)
+          for (int k = 0; k < 16; k++)
+            acc[k] = acc[k] * 0.9999999 + 1e-7;
+        double s = 0;
+        for (int k = 0; k < 16; k++)
+          s += acc[k];
+        sink[t] = s;
+      });
+    for (auto& w : pool)
+      w.join();
+    double sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    r.peakGflops = 2.0 * 16 * iters * threads / sec * 1e-9;
+  }
+  // полоса: a = b + s * c
+  {
+    const size_t n = max<size_t>(1, bytes / (3 * sizeof(double)));
+    vector<double> a(n), b(n, 1.0), c(n, 2.0);
+    const size_t part = (n + threads - 1) / threads;
+    double best = 0;
+    for (int rep = 0; rep < 3; rep++)
+    {
+      auto t0 = chrono::steady_clock::now();
+      vector<thread> pool;
+      for (size_t t = 0; t < threads; t++)
+        pool.emplace_back([&, t]()
+        {
+          size_t lo = t * part, hi = min(n, lo + part);
+          for (size_t i = lo; i < hi; i++)
+            a[i] = b[i] + 3.0 * c[i];
+        });
+      for (auto& w : pool)
+        w.join();
+      double sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+      best = max(best, 3.0 * n * sizeof(double) / sec * 1e-9);
+    }
+    r.bandwidthGBs = best;
+  }
+  return r;
+}
+
+// Отчёт roofline: для каждой операции и корзины - достигнутая скорость,
+// арифметическая интенсивность (FLOP/байт), потолок min(пик, AI * полоса),
+// чем ограничено ядро и доля потолка; запас = потолок / достигнутое
+inline void profile_report_roofline(ostream& os, const TMachineRoofline& machine)
+{
+  auto table = TProfileRegistry::instance().snapshot();
+  os << "# peak " << machine.peakGflops << " GFLOP/s, bandwidth " << machine.bandwidthGBs << " GB/s, ridge "
+    << machine.peakGflops / machine.bandwidthGBs << " FLOP/byte\n";
+  os << "op,bucket,min_size,calls,gflops,intensity,roof_gflops,bound,percent_of_roof,headroom\n";
+  for (const auto& item : table)
+  {
+    const TOpStats& st = item.second;
+    const double sec = max(st.nanoseconds, uint64_t(1)) * 1e-9;
+    const double achieved = st.flops / sec * 1e-9;
+    const double intensity = st.bytes ? double(st.flops) / st.bytes : 0.0;
+    const double memoryRoof = intensity * machine.bandwidthGBs;
+    const double roof = min(machine.peakGflops, memoryRoof);
+    os << item.first.first << ',' << item.first.second << ',' << (size_t(1) << item.first.second) << ','
+      << st.calls << ',' << achieved << ',' << intensity << ',' << roof << ','
+      << (memoryRoof < machine.peakGflops ? "memory" : "compute") << ','
+      << (roof > 0 ? 100.0 * achieved / roof : 0.0) << ',' << (achieved > 0 ? roof / achieved : 0.0) << '\n';
+  }
+}
+
+#define TMATRIX_PROFILE_OP(name, n, flops, bytes) TOpScope tmatrix_op_scope_(name, n, flops, bytes)
+#define TMATRIX_PROFILE_DEPTH() profile_depth()
+#define TMATRIX_PROFILE_NESTED(d) TProfileNesting tmatrix_profile_nesting_(d)
+
+#else
+
+#define TMATRIX_PROFILE_OP(name, n, flops, bytes)
+#define TMATRIX_PROFILE_DEPTH() 0
+#define TMATRIX_PROFILE_NESTED(d) (void)(d)
+
+#endif
+
+#endif
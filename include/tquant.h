@@ -0,0 +1,212 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Квантованные матрицы int8 с масштабами по строкам (блокам строк)
+//
+// Элемент хранится как q = round(a / s), |q| <= 127, где s - масштаб своей
+// строки (или блока из block столбцов строки). Произведения считаются в
+// целых числах с накоплением в int32 и затем умножаются на масштабы.
+
+#ifndef __TQuant_H__
+#define __TQuant_H__
+
+#include <cstdint>
+#include "tmatrix.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// скалярное произведение int8 векторов с накоплением в int32. При сборке
+// с AVX2 (-mavx2) используется vpmaddubsw + vpmaddwd, с AVX512-VNNI -
+// vpdpbusd. Обе команды перемножают беззнаковые байты на знаковые, поэтому
+// знак a переносится на b; при |q| <= 127 пары не насыщают int16.
+inline int32_t dot_i8(const int8_t* a, const int8_t* b, size_t n) noexcept
+{
+  size_t i = 0;
+  int32_t s = 0;
+#if defined(__AVX2__)
+  __m256i acc = _mm256_setzero_si256();
+#if !(defined(__AVX512VNNI__) && defined(__AVX512VL__))
+  const __m256i ones = _mm256_set1_epi16(1);
+#endif
+  for (; i + 32 <= n; i += 32)
+  {
+    const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+    const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+    const __m256i ua = _mm256_sign_epi8(va, va);
+    const __m256i sb = _mm256_sign_epi8(vb, va);
+#if defined(__AVX512VNNI__) && defined(__AVX512VL__)
+    acc = _mm256_dpbusd_epi32(acc, ua, sb);
+#else
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(_mm256_maddubs_epi16(ua, sb), ones));
+#endif
+  }
+  __m128i h = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+  h = _mm_add_epi32(h, _mm_shuffle_epi32(h, 0x4e));
+  h = _mm_add_epi32(h, _mm_shuffle_epi32(h, 0xb1));
+  s = _mm_cvtsi128_si32(h);
+#endif
+  for (; i < n; i++)
+    s += int32_t(a[i]) * int32_t(b[i]);
+  return s;
+}
+
+// симметричное квантование x[0, n) в q; возвращает масштаб (0 для нулевого блока)
+inline float quantize_i8(const float* x, size_t n, int8_t* q) noexcept
+{
+  float amax = 0;
+  for (size_t i = 0; i < n; i++)
+    amax = max(amax, fabs(x[i]));
+  if (amax == 0)
+  {
+    std::fill(q, q + n, int8_t(0));
+    return 0;
+  }
+  const float scale = amax / 127;
+  const float inv = 127 / amax;
+  for (size_t i = 0; i < n; i++)
+    q[i] = static_cast<int8_t>(lrintf(x[i] * inv));
+  return scale;
+}
+
+// Квадратная матрица n x n в int8: строки подряд, у каждой строки
+// blocks() масштабов - по одному на блок из block() столбцов
+class TQuantizedMatrix
+{
+protected:
+  size_t n;
+  size_t blk;
+  size_t nb;
+  vector<int8_t> q;
+  vector<float> scales;  // scales[i * nb + b]
+
+  // порог работы, начиная с которого строки делятся между потоками
+  static const size_t PARALLEL_QUANT_WORK = 1 << 18;
+
+  size_t grain(size_t work) const noexcept { return work < PARALLEL_QUANT_WORK ? n : 4; }
+
+  // сумма по блокам: s_ib * dot(a_i[блок b], x[блок b])
+  float row_dot(size_t i, const int8_t* x, const float* xs) const noexcept
+  {
+    const int8_t* a = row(i);
+    const float* s = scales.data() + i * nb;
+    float r = 0;
+    for (size_t b = 0; b < nb; b++)
+    {
+      const size_t lo = b * blk, len = min(blk, n - lo);
+      r += s[b] * xs[b] * static_cast<float>(dot_i8(a + lo, x + lo, len));
+    }
+    return r;
+  }
+public:
+  // block = 0 - один масштаб на всю строку
+  explicit TQuantizedMatrix(const TDynamicMatrix<float>& a, size_t block = 0)
+    : n(a.size()), blk(block == 0 || block > a.size() ? a.size() : block),
+      nb((n + blk - 1) / blk), q(n * n), scales(n * nb)
+  {
+    TMATRIX_OP("quantize", n, 2 * n * n, n * n * (sizeof(float) + 1));
+    parallel_for_range(0, n, [&](size_t lo, size_t hi)
+    {
+      for (size_t i = lo; i < hi; i++)
+      {
+        const float* r = a[i].data();
+        for (size_t b = 0; b < nb; b++)
+        {
+          const size_t c = b * blk;
+          scales[i * nb + b] = quantize_i8(r + c, min(blk, n - c), q.data() + i * n + c);
+        }
+      }
+    }, grain(n * n));
+  }
+
+  size_t size() const noexcept { return n; }
+  size_t block() const noexcept { return blk; }
+  size_t blocks() const noexcept { return nb; }
+  const int8_t* row(size_t i) const noexcept { return q.data() + i * n; }
+  float scale(size_t i, size_t b = 0) const noexcept { return scales[i * nb + b]; }
+
+  TDynamicMatrix<float> dequantize() const
+  {
+    TDynamicMatrix<float> a(n);
+    for (size_t i = 0; i < n; i++)
+    {
+      float* r = a[i].data();
+      for (size_t j = 0; j < n; j++)
+        r[j] = scale(i, j / blk) * row(i)[j];
+    }
+    return a;
+  }
+
+  // y = A * x: x квантуется на лету по тем же блокам, что и строки A
+  void multiply_to(const TDynamicVector<float>& x, TDynamicVector<float>& y) const
+  {
+    TMATRIX_OP("gemv_i8", n, 2 * n * n, n * n + 2 * n * sizeof(float));
+    if (x.size() != n)
+      throw("Error");
+    if (y.size() != n)
+      y = TDynamicVector<float>(n);
+    vector<int8_t> qx(n);
+    vector<float> xs(nb);
+    for (size_t b = 0; b < nb; b++)
+      xs[b] = quantize_i8(x.data() + b * blk, min(blk, n - b * blk), qx.data() + b * blk);
+    float* r = y.data();
+
+    parallel_for_range(0, n, [&](size_t lo, size_t hi)
+    {
+      for (size_t i = lo; i < hi; i++)
+        r[i] = row_dot(i, qx.data(), xs.data());
+    }, grain(n * n));
+  }
+  TDynamicVector<float> operator*(const TDynamicVector<float>& x) const
+  {
+    TDynamicVector<float> y(n);
+    multiply_to(x, y);
+    return y;
+  }
+
+  // C = A * B: столбцы B квантуются (каждый по блокам) и хранятся
+  // как строки, после чего c_ij - блочное скалярное произведение двух строк
+  void multiply_to(const TDynamicMatrix<float>& b, TDynamicMatrix<float>& c) const
+  {
+    TMATRIX_OP("gemm_i8", n, 2 * n * n * n, 2 * n * n + 2 * n * n * sizeof(float));
+    if (b.size() != n)
+      throw("Error");
+    if (&c == &b)
+      throw("Error!The result must not alias an operand");
+    if (c.size() != n)
+      c = TDynamicMatrix<float>(n);
+    vector<int8_t> qt(n * n);
+    vector<float> ts(n * nb);
+
+    // каждый поток транспонирует свои столбцы, читая строки B подряд
+    parallel_for_range(0, n, [&](size_t lo, size_t hi)
+    {
+      vector<float> cols((hi - lo) * n);
+      for (size_t k = 0; k < n; k++)
+      {
+        const float* bk = b[k].data();
+        for (size_t j = lo; j < hi; j++)
+          cols[(j - lo) * n + k] = bk[j];
+      }
+      for (size_t j = lo; j < hi; j++)
+        for (size_t p = 0; p < nb; p++)
+        {
+          const size_t s = p * blk;
+          ts[j * nb + p] = quantize_i8(cols.data() + (j - lo) * n + s, min(blk, n - s), qt.data() + j * n + s);
+        }
+    }, grain(n * n));
+    for (size_t i = 0; i < n; i++)
+      c[i].data();
+    parallel_for_range(0, n, [&](size_t lo, size_t hi)
+    {
+      for (size_t i = lo; i < hi; i++)
+      {
+        float* r = c[i].data();
+        for (size_t j = 0; j < n; j++)
+          r[j] = row_dot(i, qt.data() + j * n, ts.data() + j * nb);
+      }
+    }, grain(n * n * n / 8));
+  }
+};
+
+#endif
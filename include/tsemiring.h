@@ -0,0 +1,210 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Произведение матриц над полукольцами
+
+#ifndef __TSemiring_H__
+#define __TSemiring_H__
+
+#include <limits>
+#include "tmatrix.h"
+
+// Полукольцо задаёт "сложение" add, "умножение" mul и нуль zero -
+// нейтральный элемент add, поглощающий для mul: слагаемые с a[i][k] == zero
+// пропускаются целиком.
+//   TPlusTimes - обычное произведение
+//   TMinPlus   - кратчайшие пути (нуль - бесконечность, нет ребра)
+//   TMaxPlus   - самые длинные (критические) пути
+//   TMaxMin    - пути с наибольшей пропускной способностью
+//   TOrAnd     - достижимость; элементы 0/1, строки упаковываются в биты
+template<typename T>
+struct TPlusTimes
+{
+  static T zero() { return T(0); }
+  static T add(T a, T b) { return a + b; }
+  static T mul(T a, T b) { return a * b; }
+};
+
+template<typename T>
+struct TMinPlus
+{
+  static T zero()
+  {
+    return numeric_limits<T>::has_infinity ? numeric_limits<T>::infinity() : numeric_limits<T>::max();
+  }
+  static T add(T a, T b) { return b < a ? b : a; }
+  static T mul(T a, T b)
+  {
+    // для целых "бесконечность" не должна переполняться
+    if (numeric_limits<T>::has_infinity)
+      return a + b;
+    return (a == zero() || b == zero()) ? zero() : a + b;
+  }
+};
+
+template<typename T>
+struct TMaxPlus
+{
+  static T zero()
+  {
+    return numeric_limits<T>::has_infinity ? -numeric_limits<T>::infinity() : numeric_limits<T>::lowest();
+  }
+  static T add(T a, T b) { return a < b ? b : a; }
+  static T mul(T a, T b)
+  {
+    if (numeric_limits<T>::has_infinity)
+      return a + b;
+    return (a == zero() || b == zero()) ? zero() : a + b;
+  }
+};
+
+template<typename T>
+struct TMaxMin
+{
+  static T zero()
+  {
+    return numeric_limits<T>::has_infinity ? -numeric_limits<T>::infinity() : numeric_limits<T>::lowest();
+  }
+  static T add(T a, T b) { return a < b ? b : a; }
+  static T mul(T a, T b) { return b < a ? b : a; }
+};
+
+template<typename T>
+struct TOrAnd
+{
+  static T zero() { return T(0); }
+  static T add(T a, T b) { return T(a != T(0) || b != T(0)); }
+  static T mul(T a, T b) { return T(a != T(0) && b != T(0)); }
+};
+
+// объём работы (n^3), начиная с которого строки делятся между потоками
+const size_t PARALLEL_SEMIRING_WORK = 1 << 21;
+// ширина полосы столбцов: полоса строки результата остаётся в L1,
+// пока по ней проходят все k
+const size_t SEMIRING_COL_BLOCK = 512;
+
+// Битовые строки: элемент j хранится в бите j % 64 слова j / 64
+inline size_t bit_words(size_t n) noexcept { return (n + 63) / 64; }
+
+template<typename T>
+void bits_pack(const T* a, size_t n, uint64_t* w)
+{
+  std::fill(w, w + bit_words(n), uint64_t(0));
+  for (size_t j = 0; j < n; j++)
+    if (a[j] != T(0))
+      w[j / 64] |= uint64_t(1) << (j % 64);
+}
+template<typename T>
+void bits_unpack(const uint64_t* w, size_t n, T* a)
+{
+  for (size_t j = 0; j < n; j++)
+    a[j] = T((w[j / 64] >> (j % 64)) & 1);
+}
+
+// строки [lo, hi) произведения a * b над полукольцом S: порядок i-k-j,
+// столбцы идут полосами по SEMIRING_COL_BLOCK
+template<typename S, typename T>
+void semiring_multiply_rows(const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b, TDynamicMatrix<T>& res,
+  size_t lo, size_t hi)
+{
+  const size_t n = a.size();
+  const T zero = S::zero();
+
+  for (size_t i = lo; i < hi; i++)
+  {
+    T* r = res[i].data();
+    const T* ai = a[i].data();
+
+    std::fill(r, r + n, zero);
+    for (size_t jb = 0; jb < n; jb += SEMIRING_COL_BLOCK)
+    {
+      const size_t je = min(n, jb + SEMIRING_COL_BLOCK);
+      for (size_t k = 0; k < n; k++)
+      {
+        const T aik = ai[k];
+        if (aik == zero)
+          continue;
+        const T* bk = b[k].data();
+        for (size_t j = jb; j < je; j++)
+          r[j] = S::add(r[j], S::mul(aik, bk[j]));
+      }
+    }
+  }
+}
+
+// то же для (or, and): строки b упакованы в packed, строка результата
+// собирается пословным OR строк b, для которых a[i][k] != 0
+template<typename T>
+void boolean_multiply_rows(const TDynamicMatrix<T>& a, const uint64_t* packed, TDynamicMatrix<T>& res,
+  size_t lo, size_t hi)
+{
+  const size_t n = a.size();
+  const size_t words = bit_words(n);
+  vector<uint64_t> acc(words);
+
+  for (size_t i = lo; i < hi; i++)
+  {
+    const T* ai = a[i].data();
+
+    std::fill(acc.begin(), acc.end(), uint64_t(0));
+    for (size_t k = 0; k < n; k++)
+    {
+      if (ai[k] == T(0))
+        continue;
+      const uint64_t* bk = packed + k * words;
+      for (size_t w = 0; w < words; w++)
+        acc[w] |= bk[w];
+    }
+    bits_unpack(acc.data(), n, res[i].data());
+  }
+}
+
+// res = a * b над полукольцом S без выделения памяти под результат;
+// res не должна совпадать с операндами
+template<typename S, typename T>
+void semiring_multiply_to(const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b, TDynamicMatrix<T>& res)
+{
+  const size_t n = a.size();
+
+  TMATRIX_OP("semiring_gemm", n, 2 * n * n * n, 3 * n * n * sizeof(T));
+  if (b.size() != n)
+    throw("Error");
+  if (&res == &a || &res == &b)
+    throw("Error!The result must not alias an operand");
+  if (res.size() != n)
+    res = TDynamicMatrix<T>(n);
+  // разделяемые буферы результата отделяются до запуска потоков
+  for (size_t i = 0; i < n; i++)
+    res[i].data();
+  const size_t grain = (n * n * n < PARALLEL_SEMIRING_WORK) ? n : ROW_GRAIN;
+
+  if constexpr (is_same<S, TOrAnd<T>>::value)
+  {
+    const size_t words = bit_words(n);
+    vector<uint64_t> packed(n * words);
+
+    for (size_t k = 0; k < n; k++)
+      bits_pack(b[k].data(), n, packed.data() + k * words);
+    parallel_for_range(0, n, [&](size_t lo, size_t hi)
+    {
+      boolean_multiply_rows(a, packed.data(), res, lo, hi);
+    }, grain);
+  }
+  else
+  {
+    parallel_for_range(0, n, [&](size_t lo, size_t hi)
+    {
+      semiring_multiply_rows<S>(a, b, res, lo, hi);
+    }, grain);
+  }
+}
+
+template<typename S, typename T>
+TDynamicMatrix<T> semiring_multiply(const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b)
+{
+  TDynamicMatrix<T> res(a.size());
+
+  semiring_multiply_to<S>(a, b, res);
+  return res;
+}
+
+#endif
@@ -0,0 +1,437 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Итерационные методы Крылова: CG, BiCGSTAB, GMRES(m)
+//
+// Оператор A - любой тип, для которого определено apply_operator(A, x, y)
+// (y = A * x): TDynamicMatrix, TSparseMatrix или функтор f(x, y).
+// Предобусловливатель M - тип с методом apply(r, z) (z = M^-1 * r).
+// Рабочие векторы выделяются один раз на вызов, итерации память не выделяют.
+
+#ifndef __TSolvers_H__
+#define __TSolvers_H__
+
+#include <cmath>
+#include <limits>
+#include "tmatrix.h"
+#include "tsparse.h"
+
+// Применение оператора: y = A * x
+template<typename T>
+void apply_operator(const TDynamicMatrix<T>& a, const TDynamicVector<T>& x, TDynamicVector<T>& y)
+{
+  a.multiply_to(x, y);
+}
+template<typename T>
+void apply_operator(const TSparseMatrix<T>& a, const TDynamicVector<T>& x, TDynamicVector<T>& y)
+{
+  a.multiply_to(x, y);
+}
+template<typename Op, typename T>
+void apply_operator(const Op& a, const TDynamicVector<T>& x, TDynamicVector<T>& y)
+{
+  a(x, y);
+}
+
+// Итог работы решателя
+struct TSolverResult
+{
+  size_t iterations;
+  double residual;    // относительная невязка ||b - Ax|| / ||b||
+  bool converged;
+};
+
+// Предобусловливатели
+
+// без предобусловливания
+template<typename T>
+class TIdentityPreconditioner
+{
+public:
+  void apply(const TDynamicVector<T>& r, TDynamicVector<T>& z) const
+  {
+    std::copy(r.data(), r.data() + r.size(), z.data());
+  }
+};
+
+// Якоби: M = diag(A)
+template<typename T>
+class TJacobiPreconditioner
+{
+protected:
+  TDynamicVector<T> invDiag;
+public:
+  explicit TJacobiPreconditioner(const TDynamicMatrix<T>& a) : invDiag(a.size())
+  {
+    for (size_t i = 0; i < a.size(); i++)
+      invDiag[i] = inverse(a[i][i]);
+  }
+  explicit TJacobiPreconditioner(const TSparseMatrix<T>& a) : invDiag(a.size())
+  {
+    for (size_t i = 0; i < a.size(); i++)
+      invDiag[i] = inverse(a.get(i, i));
+  }
+  void apply(const TDynamicVector<T>& r, TDynamicVector<T>& z) const
+  {
+    const T* d = invDiag.data();
+    const T* x = r.data();
+    T* y = z.data();
+    for (size_t i = 0; i < r.size(); i++)
+      y[i] = d[i] * x[i];
+  }
+private:
+  static T inverse(const T& d)
+  {
+    if (d == T())
+      throw("Error!Zero diagonal element");
+    return T(1) / d;
+  }
+};
+
+// Неполное LU-разложение без заполнения (ILU(0)) на портрете A
+template<typename T>
+class TILU0Preconditioner
+{
+protected:
+  TSparseMatrix<T> lu;       // L (единичная диагональ не хранится) и U в одной структуре
+  vector<size_t> diagPos;
+public:
+  explicit TILU0Preconditioner(const TDynamicMatrix<T>& a) : TILU0Preconditioner(TSparseMatrix<T>(a)) {}
+  explicit TILU0Preconditioner(const TSparseMatrix<T>& a) : lu(a), diagPos(a.size())
+  {
+    const size_t n = lu.size();
+    const vector<size_t>& rp = lu.rowPointers();
+    const vector<size_t>& col = lu.columns();
+    vector<T>& val = lu.values();
+    const size_t none = rp[n];
+    vector<size_t> pos(n, none);
+
+    for (size_t i = 0; i < n; i++)
+    {
+      diagPos[i] = none;
+      for (size_t k = rp[i]; k < rp[i + 1]; k++)
+        if (col[k] == i)
+          diagPos[i] = k;
+      if (diagPos[i] == none)
+        throw("Error!ILU0 requires a stored diagonal");
+    }
+    for (size_t i = 1; i < n; i++)
+    {
+      for (size_t k = rp[i]; k < rp[i + 1]; k++)
+        pos[col[k]] = k;
+      for (size_t k = rp[i]; k < rp[i + 1] && col[k] < i; k++)
+      {
+        const size_t r = col[k];
+        if (val[diagPos[r]] == T())
+          throw("Error!Zero pivot in ILU0");
+        val[k] /= val[diagPos[r]];
+        for (size_t m = diagPos[r] + 1; m < rp[r + 1]; m++)
+          if (pos[col[m]] != none)
+            val[pos[col[m]]] -= val[k] * val[m];
+      }
+      for (size_t k = rp[i]; k < rp[i + 1]; k++)
+        pos[col[k]] = none;
+    }
+    // нулевой опорный элемент строки, на столбец которой не ссылаются
+    // последующие строки, при исключении не встречается
+    for (size_t i = 0; i < n; i++)
+      if (val[diagPos[i]] == T())
+        throw("Error!Zero pivot in ILU0");
+  }
+  // z = U^-1 L^-1 r
+  void apply(const TDynamicVector<T>& r, TDynamicVector<T>& z) const
+  {
+    const size_t n = lu.size();
+    const vector<size_t>& rp = lu.rowPointers();
+    const vector<size_t>& col = lu.columns();
+    const vector<T>& val = lu.values();
+    const T* x = r.data();
+    T* y = z.data();
+
+    for (size_t i = 0; i < n; i++)
+    {
+      T s = x[i];
+      for (size_t k = rp[i]; k < diagPos[i]; k++)
+        s -= val[k] * y[col[k]];
+      y[i] = s;
+    }
+    for (size_t i = n; i-- > 0;)
+    {
+      T s = y[i];
+      for (size_t k = diagPos[i] + 1; k < rp[i + 1]; k++)
+        s -= val[k] * y[col[k]];
+      y[i] = s / val[diagPos[i]];
+    }
+  }
+};
+
+// Слитые векторные ядра (один проход по памяти)
+
+template<typename T>
+T dot(const TDynamicVector<T>& x, const TDynamicVector<T>& y)
+{
+  const T* a = x.data();
+  const T* b = y.data();
+  T s{};
+  for (size_t i = 0; i < x.size(); i++)
+    s += a[i] * b[i];
+  return s;
+}
+template<typename T>
+double norm2(const TDynamicVector<T>& x)
+{
+  return sqrt(static_cast<double>(dot(x, x)));
+}
+// r = b - A*x (ax - рабочий вектор)
+template<typename Op, typename T>
+void residual_to(const Op& a, const TDynamicVector<T>& b, const TDynamicVector<T>& x,
+  TDynamicVector<T>& ax, TDynamicVector<T>& r)
+{
+  apply_operator(a, x, ax);
+  const T* pb = b.data();
+  const T* pa = as_const(ax).data();
+  T* pr = r.data();
+  for (size_t i = 0; i < b.size(); i++)
+    pr[i] = pb[i] - pa[i];
+}
+// x += alpha*p; r -= alpha*q; возвращает (r, r)
+template<typename T>
+T fused_cg_update(TDynamicVector<T>& x, TDynamicVector<T>& r,
+  const TDynamicVector<T>& p, const TDynamicVector<T>& q, T alpha)
+{
+  T* px = x.data();
+  T* pr = r.data();
+  const T* pp = p.data();
+  const T* pq = q.data();
+  T rr{};
+  for (size_t i = 0; i < x.size(); i++)
+  {
+    px[i] += alpha * pp[i];
+    pr[i] -= alpha * pq[i];
+    rr += pr[i] * pr[i];
+  }
+  return rr;
+}
+// p = z + beta*p
+template<typename T>
+void fused_xpby(const TDynamicVector<T>& z, T beta, TDynamicVector<T>& p)
+{
+  T* pp = p.data();
+  const T* pz = z.data();
+  for (size_t i = 0; i < p.size(); i++)
+    pp[i] = pz[i] + beta * pp[i];
+}
+
+// Метод сопряжённых градиентов (A симметрична и положительно определена)
+template<typename Op, typename T, typename Prec = TIdentityPreconditioner<T>>
+TSolverResult cg(const Op& a, const TDynamicVector<T>& b, TDynamicVector<T>& x, const Prec& m = Prec(),
+  size_t maxIter = 1000, double tol = 1e-10)
+{
+  const size_t n = b.size();
+  if (x.size() != n)
+    throw("Error!The lengths of the vectors are not equal");
+  TDynamicVector<T> r(n), z(n), p(n), q(n);
+  const double bnorm = max(norm2(b), 1e-300);
+
+  residual_to(a, b, x, q, r);
+  double res = norm2(r) / bnorm;
+  if (res <= tol)
+    return { 0, res, true };
+  m.apply(r, z);
+  std::copy(z.data(), z.data() + n, p.data());
+  T rz = dot(r, z);
+  for (size_t it = 1; it <= maxIter; it++)
+  {
+    apply_operator(a, p, q);
+    const T pq = dot(p, q);
+    if (pq == T())
+      return { it, res, false };
+    const T alpha = rz / pq;
+    res = sqrt(static_cast<double>(fused_cg_update(x, r, p, q, alpha))) / bnorm;
+    if (res <= tol)
+      return { it, res, true };
+    m.apply(r, z);
+    const T rzNew = dot(r, z);
+    fused_xpby(z, rzNew / rz, p);
+    rz = rzNew;
+  }
+  return { maxIter, res, false };
+}
+
+// Стабилизированный метод бисопряжённых градиентов (правое предобусловливание)
+template<typename Op, typename T, typename Prec = TIdentityPreconditioner<T>>
+TSolverResult bicgstab(const Op& a, const TDynamicVector<T>& b, TDynamicVector<T>& x, const Prec& m = Prec(),
+  size_t maxIter = 1000, double tol = 1e-10)
+{
+  const size_t n = b.size();
+  if (x.size() != n)
+    throw("Error!The lengths of the vectors are not equal");
+  TDynamicVector<T> r(n), rhat(n), p(n), v(n), ph(n), sh(n), t(n);
+  const double bnorm = max(norm2(b), 1e-300);
+
+  residual_to(a, b, x, v, r);
+  double res = norm2(r) / bnorm;
+  if (res <= tol)
+    return { 0, res, true };
+  std::copy(r.data(), r.data() + n, rhat.data());
+  std::fill(v.data(), v.data() + n, T());
+  T rho = T(1), alpha = T(1), omega = T(1);
+  // указатели берутся один раз: буферы рабочих векторов не разделяются
+  T* px = x.data();
+  T* pr = r.data();
+  T* pp = p.data();
+  const T* pv = as_const(v).data();
+  const T* pph = as_const(ph).data();
+  const T* psh = as_const(sh).data();
+  const T* pt = as_const(t).data();
+  for (size_t it = 1; it <= maxIter; it++)
+  {
+    const T rhoNew = dot(rhat, r);
+    if (rhoNew == T() || omega == T())
+      return { it, res, false };
+    const T beta = (rhoNew / rho) * (alpha / omega);
+    for (size_t i = 0; i < n; i++)
+      pp[i] = pr[i] + beta * (pp[i] - omega * pv[i]);
+    m.apply(p, ph);
+    apply_operator(a, ph, v);
+    const T rv = dot(rhat, v);
+    if (rv == T())
+      return { it, res, false };
+    alpha = rhoNew / rv;
+    T ss{};
+    for (size_t i = 0; i < n; i++)
+    {
+      pr[i] -= alpha * pv[i];        // r хранит s = r - alpha*v
+      ss += pr[i] * pr[i];
+    }
+    if (sqrt(static_cast<double>(ss)) / bnorm <= tol)
+    {
+      for (size_t i = 0; i < n; i++)
+        px[i] += alpha * pph[i];
+      return { it, sqrt(static_cast<double>(ss)) / bnorm, true };
+    }
+    m.apply(r, sh);
+    apply_operator(a, sh, t);
+    T ts{}, tt{};
+    for (size_t i = 0; i < n; i++)
+    {
+      ts += pt[i] * pr[i];
+      tt += pt[i] * pt[i];
+    }
+    omega = (tt == T()) ? T() : ts / tt;
+    T rr{};
+    for (size_t i = 0; i < n; i++)
+    {
+      px[i] += alpha * pph[i] + omega * psh[i];
+      pr[i] -= omega * pt[i];
+      rr += pr[i] * pr[i];
+    }
+    res = sqrt(static_cast<double>(rr)) / bnorm;
+    if (res <= tol)
+      return { it, res, true };
+    rho = rhoNew;
+  }
+  return { maxIter, res, false };
+}
+
+// GMRES с перезапуском через restart итераций (правое предобусловливание);
+// maxIter - общее число итераций Арнольди
+template<typename Op, typename T, typename Prec = TIdentityPreconditioner<T>>
+TSolverResult gmres(const Op& a, const TDynamicVector<T>& b, TDynamicVector<T>& x, const Prec& m = Prec(),
+  size_t restart = 30, size_t maxIter = 1000, double tol = 1e-10)
+{
+  const size_t n = b.size();
+  if (x.size() != n)
+    throw("Error!The lengths of the vectors are not equal");
+  if (restart == 0)
+    throw("Error!Restart length should be greater than zero");
+  restart = min(restart, n);
+
+  vector<TDynamicVector<T>> basis(restart + 1, TDynamicVector<T>(n));
+  vector<T> h((restart + 1) * restart), cs(restart), sn(restart), g(restart + 1), y(restart);
+  TDynamicVector<T> w(n), z(n);
+  const double bnorm = max(norm2(b), 1e-300);
+  size_t it = 0;
+  double res = 0;
+  bool breakdown = false;
+
+  while (true)
+  {
+    residual_to(a, b, x, w, basis[0]);
+    const double beta = norm2(basis[0]);
+    res = beta / bnorm;
+    if (res <= tol || it >= maxIter)
+      return { it, res, res <= tol };
+    basis[0] *= T(1 / beta);
+    std::fill(g.begin(), g.end(), T());
+    g[0] = T(beta);
+
+    size_t k = 0;
+    while (k < restart && it < maxIter)
+    {
+      m.apply(basis[k], z);
+      apply_operator(a, z, w);
+      double col = 0;                           // |A z| - масштаб столбца k
+      for (size_t i = 0; i <= k; i++)           // модифицированный Грам-Шмидт
+      {
+        const T hik = dot(w, basis[i]);
+        h[i * restart + k] = hik;
+        col += static_cast<double>(hik * hik);
+        w.axpy(-hik, basis[i]);
+      }
+      const T hk1 = T(norm2(w));
+      h[(k + 1) * restart + k] = hk1;
+      col = sqrt(col + static_cast<double>(hk1 * hk1));
+      if (hk1 != T())
+        basis[k + 1].axpby(T(1) / hk1, w, T());
+
+      for (size_t i = 0; i < k; i++)            // вращения Гивенса
+      {
+        const T t1 = h[i * restart + k], t2 = h[(i + 1) * restart + k];
+        h[i * restart + k] = cs[i] * t1 + sn[i] * t2;
+        h[(i + 1) * restart + k] = -sn[i] * t1 + cs[i] * t2;
+      }
+      const T hkk = h[k * restart + k];
+      const T den = T(sqrt(static_cast<double>(hkk * hkk + hk1 * hk1)));
+      // нулевой (в пределах точности) диагональный элемент: A M^-1 вырождена
+      // на подпространстве Крылова, столбец k в решение не входит
+      if (static_cast<double>(den) <= numeric_limits<T>::epsilon() * col)
+      {
+        breakdown = true;
+        break;
+      }
+      cs[k] = (den == T()) ? T(1) : hkk / den;
+      sn[k] = (den == T()) ? T() : hk1 / den;
+      h[k * restart + k] = den;
+      h[(k + 1) * restart + k] = T();
+      g[k + 1] = -sn[k] * g[k];
+      g[k] = cs[k] * g[k];
+
+      k++;
+      it++;
+      res = fabs(static_cast<double>(g[k])) / bnorm;
+      if (res <= tol || hk1 == T())
+        break;
+    }
+
+    for (size_t i = k; i-- > 0;)                // H y = g, H - верхнетреугольная
+    {
+      T s = g[i];
+      for (size_t j = i + 1; j < k; j++)
+        s -= h[i * restart + j] * y[j];
+      y[i] = s / h[i * restart + i];
+    }
+    std::fill(w.data(), w.data() + n, T());
+    for (size_t i = 0; i < k; i++)
+      w.axpy(y[i], basis[i]);
+    m.apply(w, z);
+    x += z;
+    if (breakdown)
+    {
+      residual_to(a, b, x, w, z);
+      res = norm2(z) / bnorm;
+      return { it, res, res <= tol };
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,140 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Разреженная матрица в формате CSR
+
+#ifndef __TSparseMatrix_H__
+#define __TSparseMatrix_H__
+
+#include "tmatrix.h"
+
+// Элемент разреженной матрицы для построения из списка
+template<typename T>
+struct TTriplet
+{
+  size_t row;
+  size_t col;
+  T val;
+};
+
+// Разреженная квадратная матрица - 
+// построчное сжатое хранение (CSR), столбцы в строке упорядочены
+template<typename T>
+class TSparseMatrix
+{
+protected:
+  size_t sz;
+  vector<size_t> rowPtr;
+  vector<size_t> colInd;
+  vector<T> vals;
+
+  static const size_t PARALLEL_SPMV_NNZ = 1 << 18;
+public:
+  TSparseMatrix(size_t s = 1) : sz(s), rowPtr(s + 1, 0)
+  {
+    if (sz == 0)
+      throw out_of_range("Matrix size should be greater than zero");
+    if (sz > get_max_vector_size())
+      throw out_of_range("max_vector_size");
+  }
+  // из списка элементов; повторяющиеся позиции суммируются
+  TSparseMatrix(size_t s, vector<TTriplet<T>> elems) : TSparseMatrix(s)
+  {
+    for (const auto& e : elems)
+      if (e.row >= sz || e.col >= sz)
+        throw("Error!Triplet index is out of range");
+    sort(elems.begin(), elems.end(), [](const TTriplet<T>& a, const TTriplet<T>& b)
+    {
+      return a.row < b.row || (a.row == b.row && a.col < b.col);
+    });
+    for (size_t k = 0; k < elems.size(); k++)
+    {
+      if (!colInd.empty() && k > 0 && elems[k - 1].row == elems[k].row && elems[k - 1].col == elems[k].col)
+      {
+        vals.back() += elems[k].val;
+        continue;
+      }
+      colInd.push_back(elems[k].col);
+      vals.push_back(elems[k].val);
+      rowPtr[elems[k].row + 1]++;
+    }
+    for (size_t i = 0; i < sz; i++)
+      rowPtr[i + 1] += rowPtr[i];
+  }
+  // из плотной матрицы (нулевые элементы отбрасываются)
+  explicit TSparseMatrix(const TDynamicMatrix<T>& m) : TSparseMatrix(m.size())
+  {
+    for (size_t i = 0; i < sz; i++)
+    {
+      for (size_t j = 0; j < sz; j++)
+        if (m[i][j] != T())
+        {
+          colInd.push_back(j);
+          vals.push_back(m[i][j]);
+        }
+      rowPtr[i + 1] = colInd.size();
+    }
+  }
+
+  size_t size() const noexcept { return sz; }
+  size_t nonzeros() const noexcept { return vals.size(); }
+
+  // структура CSR
+  const vector<size_t>& rowPointers() const noexcept { return rowPtr; }
+  const vector<size_t>& columns() const noexcept { return colInd; }
+  const vector<T>& values() const noexcept { return vals; }
+  vector<T>& values() noexcept { return vals; }
+
+  // элемент (i, j), нулевой если не хранится
+  T get(size_t i, size_t j) const
+  {
+    if (i >= sz || j >= sz)
+      throw("Error!Index is out of range");
+    auto first = colInd.begin() + rowPtr[i], last = colInd.begin() + rowPtr[i + 1];
+    auto it = lower_bound(first, last, j);
+    return (it != last && *it == j) ? vals[it - colInd.begin()] : T();
+  }
+
+  TDynamicMatrix<T> toDense() const
+  {
+    TDynamicMatrix<T> m(sz);
+    for (size_t i = 0; i < sz; i++)
+      for (size_t k = rowPtr[i]; k < rowPtr[i + 1]; k++)
+        m[i][colInd[k]] = vals[k];
+    return m;
+  }
+
+  // res = A * v без выделения памяти; строки делятся между потоками
+  void multiply_to(const TDynamicVector<T>& v, TDynamicVector<T>& res) const
+  {
+    if (v.size() != sz)
+      throw("Error");
+    if (&res == &v)
+      throw("Error!The result must not alias an operand");
+    if (res.size() != sz)
+      res = TDynamicVector<T>(sz);
+    const T* x = v.data();
+    T* r = res.data();
+    auto rows = [&](size_t lo, size_t hi)
+    {
+      for (size_t i = lo; i < hi; i++)
+      {
+        T s{};
+        for (size_t k = rowPtr[i]; k < rowPtr[i + 1]; k++)
+          s += vals[k] * x[colInd[k]];
+        r[i] = s;
+      }
+    };
+    if (vals.size() < PARALLEL_SPMV_NNZ)
+      rows(0, sz);
+    else
+      parallel_for_range(0, sz, rows);
+  }
+  TDynamicVector<T> operator*(const TDynamicVector<T>& v) const
+  {
+    TDynamicVector<T> res(sz);
+    multiply_to(v, res);
+    return res;
+  }
+};
+
+#endif
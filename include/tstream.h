@@ -0,0 +1,305 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Потоковая обработка матриц по блокам строк
+//
+// Строки читаются из istream блоками по block строк и проходят конвейер
+// чтение -> преобразование -> умножение на вектор -> форматирование.
+// Стадии работают в отдельных потоках и связаны каналами ограниченной
+// ёмкости, поэтому в памяти одновременно находится O(depth) блоков,
+// а не вся матрица N x N.
+//
+// Источник блоков row_blocks - генератор: при сборке с C++20 это
+// сопрограмма (co_yield), в C++17 - класс с тем же методом next().
+
+#ifndef __TStream_H__
+#define __TStream_H__
+
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <sstream>
+#include <string>
+#include "tmatrix.h"
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define TSTREAM_COROUTINES 1
+#endif
+
+// блок подряд идущих строк
+template<typename T>
+using TRowBlock = vector<TDynamicVector<T>>;
+
+// Канал ограниченной ёмкости между стадиями: push ждёт свободного места,
+// pop - элемента. После close() оставшиеся элементы ещё можно забрать,
+// после cancel() они отбрасываются; push в закрытый канал возвращает false.
+template<typename T>
+class TChannel
+{
+protected:
+  queue<T> items;
+  size_t cap;
+  bool closed;
+  mutex m;
+  condition_variable notFull, notEmpty;
+public:
+  explicit TChannel(size_t capacity) : cap(capacity == 0 ? 1 : capacity), closed(false) {}
+  TChannel(const TChannel&) = delete;
+  TChannel& operator=(const TChannel&) = delete;
+
+  size_t capacity() const noexcept { return cap; }
+  bool push(T v)
+  {
+    unique_lock<mutex> g(m);
+    notFull.wait(g, [this] { return closed || items.size() < cap; });
+    if (closed)
+      return false;
+    items.push(std::move(v));
+    notEmpty.notify_one();
+    return true;
+  }
+  optional<T> pop()
+  {
+    unique_lock<mutex> g(m);
+    notEmpty.wait(g, [this] { return closed || !items.empty(); });
+    if (items.empty())
+      return nullopt;
+    optional<T> v(std::move(items.front()));
+    items.pop();
+    notFull.notify_one();
+    return v;
+  }
+  void close()
+  {
+    lock_guard<mutex> g(m);
+    closed = true;
+    notFull.notify_all();
+    notEmpty.notify_all();
+  }
+  void cancel()
+  {
+    lock_guard<mutex> g(m);
+    closed = true;
+    items = queue<T>();
+    notFull.notify_all();
+    notEmpty.notify_all();
+  }
+};
+
+// count строк по cols элементов в формате operator>>
+template<typename T>
+TRowBlock<T> read_row_block(istream& in, size_t cols, size_t count)
+{
+  TRowBlock<T> b;
+  b.reserve(count);
+  for (size_t k = 0; k < count; k++)
+  {
+    TDynamicVector<T> r(cols);
+    in >> r;
+    if (!in)
+      throw("Error!Unexpected end of stream");
+    b.push_back(std::move(r));
+  }
+  return b;
+}
+
+#if defined(TSTREAM_COROUTINES)
+// Генератор на сопрограмме: значения вычисляются по одному при next()
+template<typename T>
+class TGenerator
+{
+public:
+  struct promise_type
+  {
+    optional<T> current;
+    exception_ptr error;
+
+    TGenerator get_return_object() { return TGenerator(coroutine_handle<promise_type>::from_promise(*this)); }
+    suspend_always initial_suspend() noexcept { return {}; }
+    suspend_always final_suspend() noexcept { return {}; }
+    suspend_always yield_value(T v)
+    {
+      current = std::move(v);
+      return {};
+    }
+    void return_void() {}
+    void unhandled_exception() { error = current_exception(); }
+  };
+protected:
+  coroutine_handle<promise_type> h;
+public:
+  explicit TGenerator(coroutine_handle<promise_type> handle) : h(handle) {}
+  TGenerator(TGenerator&& g) noexcept : h(g.h) { g.h = nullptr; }
+  TGenerator(const TGenerator&) = delete;
+  TGenerator& operator=(const TGenerator&) = delete;
+  ~TGenerator()
+  {
+    if (h)
+      h.destroy();
+  }
+
+  // следующее значение или nullopt по окончании
+  optional<T> next()
+  {
+    if (!h || h.done())
+      return nullopt;
+    h.resume();
+    if (h.promise().error)
+      rethrow_exception(h.promise().error);
+    if (h.done())
+      return nullopt;
+    optional<T> v(std::move(h.promise().current));
+    h.promise().current.reset();
+    return v;
+  }
+};
+
+// rows строк из in блоками по block строк
+template<typename T>
+TGenerator<TRowBlock<T>> row_blocks(istream& in, size_t cols, size_t rows, size_t block)
+{
+  for (size_t i = 0; i < rows; i += block)
+    co_yield read_row_block<T>(in, cols, min(block, rows - i));
+}
+#else
+// то же без сопрограмм: состояние генератора хранится явно
+template<typename T>
+class TRowBlockReader
+{
+protected:
+  istream* in;
+  size_t cols, left, block;
+public:
+  TRowBlockReader(istream& s, size_t c, size_t rows, size_t b) : in(&s), cols(c), left(rows), block(b) {}
+
+  optional<TRowBlock<T>> next()
+  {
+    if (left == 0)
+      return nullopt;
+    const size_t count = min(block, left);
+    left -= count;
+    return read_row_block<T>(*in, cols, count);
+  }
+};
+
+template<typename T>
+TRowBlockReader<T> row_blocks(istream& in, size_t cols, size_t rows, size_t block)
+{
+  return TRowBlockReader<T>(in, cols, rows, block);
+}
+#endif
+
+// y = f(A) * x для матрицы rows x x.size(), читаемой из in по строкам;
+// f(row) меняет строку на месте. y пишется в out в формате operator<< вектора.
+// Стадии чтения, преобразования, умножения и форматирования идут
+// параллельно, между ними - не более depth блоков по block строк. Ошибка
+// любой стадии останавливает конвейер и перебрасывается вызывающему.
+template<typename T, typename F>
+void stream_gemv(istream& in, ostream& out, const TDynamicVector<T>& x, size_t rows, F transform,
+  size_t block = 64, size_t depth = 2)
+{
+  const size_t cols = x.size();
+
+  TMATRIX_OP("stream_gemv", rows, 2 * rows * cols, (rows * cols + cols + rows) * sizeof(T));
+  // операции внутри стадий вложены в stream_gemv и не профилируются отдельно
+  const int nesting = TMATRIX_PROFILE_DEPTH();
+  if (block == 0)
+    block = 1;
+  TChannel<TRowBlock<T>> parsed(depth), transformed(depth);
+  TChannel<TDynamicVector<T>> products(depth);
+  TChannel<string> text(depth);
+  mutex em;
+  exception_ptr error;
+
+  auto fail = [&](exception_ptr e)
+  {
+    {
+      lock_guard<mutex> g(em);
+      if (!error)
+        error = e;
+    }
+    parsed.cancel();
+    transformed.cancel();
+    products.cancel();
+    text.cancel();
+  };
+  // стадия в своём потоке; по завершении закрывает выходной канал
+  auto stage = [&](auto body, auto& output)
+  {
+    return thread([&fail, &output, body, nesting]() mutable
+    {
+      TMATRIX_PROFILE_NESTED(nesting);
+      try
+      {
+        body();
+      }
+      catch (...)
+      {
+        fail(current_exception());
+      }
+      output.close();
+    });
+  };
+
+  thread workers[] = {
+    stage([&]()
+    {
+      auto src = row_blocks<T>(in, cols, rows, block);
+      while (auto b = src.next())
+        if (!parsed.push(std::move(*b)))
+          break;
+    }, parsed),
+    stage([&]()
+    {
+      while (auto b = parsed.pop())
+      {
+        for (auto& r : *b)
+          transform(r);
+        if (!transformed.push(std::move(*b)))
+          break;
+      }
+    }, transformed),
+    stage([&]()
+    {
+      const T* v = x.data();
+      while (auto b = transformed.pop())
+      {
+        TDynamicVector<T> y(b->size());
+        T* r = y.data();
+        for (size_t k = 0; k < b->size(); k++)
+        {
+          const T* a = as_const((*b)[k]).data();
+          r[k] = reduce_naive<T>(0, cols, [a, v](size_t j) { return a[j] * v[j]; });
+        }
+        if (!products.push(std::move(y)))
+          break;
+      }
+    }, products),
+    stage([&]()
+    {
+      while (auto y = products.pop())
+      {
+        ostringstream s;
+        s << *y;
+        if (!text.push(s.str()))
+          break;
+      }
+    }, text)
+  };
+
+  while (auto s = text.pop())
+  {
+    if (!(out << *s))
+    {
+      fail(make_exception_ptr("Error!Stream write failed"));
+      break;
+    }
+  }
+  for (auto& w : workers)
+    w.join();
+  if (error)
+    rethrow_exception(error);
+}
+
+#endif
@@ -0,0 +1,371 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Матрицы на диске (out-of-core), разбитые на квадратные плитки
+
+#ifndef __TTiled_H__
+#define __TTiled_H__
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include "tmatrix.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TTILED_POSIX 1
+#else
+#include <cstdio>
+#endif
+
+// Статистика загрузок плиток при умножении
+struct TTiledStats
+{
+  size_t loads;   // плиток прочитано с диска (A, B и частичные суммы C)
+  size_t reuses;  // использований плитки A из памяти вместо чтения
+};
+
+// Квадратная матрица n x n в одном файле. Файл разбит на плитки tile x tile,
+// каждая плитка хранится подряд по строкам, плитки идут по строкам сетки;
+// краевые плитки дополнены нулями до полного размера. Размер не ограничен
+// get_max_matrix_size() - в памяти одновременно держится лишь несколько плиток.
+template<typename T>
+class TTiledMatrix
+{
+protected:
+  size_t n;
+  size_t tile;
+  size_t nt;  // плиток по каждой стороне
+  // объём работы на плитку (tile^3), начиная с которого её строки делятся между потоками
+  static const size_t PARALLEL_TILE_WORK = 1 << 21;
+#if defined(TTILED_POSIX)
+  int fd;
+#else
+  FILE* file;
+  mutable mutex io;
+#endif
+
+  size_t tile_elems() const noexcept { return tile * tile; }
+  uint64_t tile_offset(size_t ti, size_t tj) const noexcept
+  {
+    return (static_cast<uint64_t>(ti) * nt + tj) * tile_elems() * sizeof(T);
+  }
+  void read_bytes(void* p, size_t bytes, uint64_t off) const
+  {
+#if defined(TTILED_POSIX)
+    char* c = static_cast<char*>(p);
+    while (bytes > 0)
+    {
+      const ssize_t r = pread(fd, c, bytes, static_cast<off_t>(off));
+      if (r <= 0)
+        throw("Error!Tile read failed");
+      c += r;
+      bytes -= static_cast<size_t>(r);
+      off += static_cast<uint64_t>(r);
+    }
+#else
+    lock_guard<mutex> g(io);
+    if (_fseeki64(file, static_cast<long long>(off), SEEK_SET) != 0 || fread(p, 1, bytes, file) != bytes)
+      throw("Error!Tile read failed");
+#endif
+  }
+  void write_bytes(const void* p, size_t bytes, uint64_t off)
+  {
+#if defined(TTILED_POSIX)
+    const char* c = static_cast<const char*>(p);
+    while (bytes > 0)
+    {
+      const ssize_t r = pwrite(fd, c, bytes, static_cast<off_t>(off));
+      if (r <= 0)
+        throw("Error!Tile write failed");
+      c += r;
+      bytes -= static_cast<size_t>(r);
+      off += static_cast<uint64_t>(r);
+    }
+#else
+    lock_guard<mutex> g(io);
+    if (_fseeki64(file, static_cast<long long>(off), SEEK_SET) != 0 || fwrite(p, 1, bytes, file) != bytes)
+      throw("Error!Tile write failed");
+#endif
+  }
+  // Поток упреждающего чтения плиток: один на всё умножение, запросы
+  // выполняются по очереди в порядке поступления
+  class TTilePrefetcher
+  {
+    struct TRequest { const TTiledMatrix* m; size_t ti, tj; T* buf; };
+    queue<TRequest> requests;
+    size_t submitted = 0, completed = 0;
+    exception_ptr error;
+    bool stop = false;
+    mutex mtx;
+    condition_variable cv;
+    thread worker;
+
+    void run()
+    {
+      unique_lock<mutex> g(mtx);
+      for (;;)
+      {
+        cv.wait(g, [this] { return stop || !requests.empty(); });
+        if (requests.empty())
+          return;
+        const TRequest r = requests.front();
+        requests.pop();
+        g.unlock();
+        exception_ptr e;
+        try
+        {
+          r.m->read_tile(r.ti, r.tj, r.buf);
+        }
+        catch (...)
+        {
+          e = current_exception();
+        }
+        g.lock();
+        if (e && !error)
+          error = e;
+        completed++;
+        cv.notify_all();
+      }
+    }
+  public:
+    TTilePrefetcher() : worker([this] { run(); }) {}
+    TTilePrefetcher(const TTilePrefetcher&) = delete;
+    TTilePrefetcher& operator=(const TTilePrefetcher&) = delete;
+    ~TTilePrefetcher()
+    {
+      {
+        lock_guard<mutex> g(mtx);
+        stop = true;
+      }
+      cv.notify_all();
+      worker.join();
+    }
+    // номер запроса для wait
+    size_t submit(const TTiledMatrix& m, size_t ti, size_t tj, T* buf)
+    {
+      lock_guard<mutex> g(mtx);
+      requests.push({ &m, ti, tj, buf });
+      cv.notify_all();
+      return submitted++;
+    }
+    // ждёт выполнения запроса ticket; ошибка чтения перебрасывается
+    void wait(size_t ticket)
+    {
+      unique_lock<mutex> g(mtx);
+      cv.wait(g, [this, ticket] { return completed > ticket; });
+      if (error)
+        rethrow_exception(error);
+    }
+  };
+public:
+  // truncate = true - новый файл из нулей (старое содержимое теряется),
+  // false - открыть существующий файл того же размера
+  TTiledMatrix(const string& path, size_t size, size_t tileSize = 1024, bool truncate = true)
+    : n(size), tile(tileSize), nt(0)
+  {
+    if (n == 0 || tile == 0)
+      throw out_of_range("Matrix size should be greater than zero");
+    nt = (n + tile - 1) / tile;
+    if (tile > (size_t(1) << 16))
+      throw out_of_range("Tile size should not exceed 65536");
+    const uint64_t bytes = checked_mul(checked_mul(checked_mul(nt, nt), tile_elems()), sizeof(T));
+#if defined(TTILED_POSIX)
+    fd = open(path.c_str(), O_RDWR | O_CREAT | (truncate ? O_TRUNC : 0), 0644);
+    if (fd < 0)
+      throw("Error!Cannot open tile file");
+    struct stat st;
+    if (truncate ? ftruncate(fd, static_cast<off_t>(bytes)) != 0
+                 : fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) != bytes)
+    {
+      close(fd);
+      throw("Error!Tile file has wrong size");
+    }
+#else
+    file = fopen(path.c_str(), truncate ? "w+b" : "r+b");
+    if (!file)
+      throw("Error!Cannot open tile file");
+    if (truncate)
+    {
+      vector<T> zero(tile_elems());
+      for (size_t t = 0; t < nt * nt; t++)
+        fwrite(zero.data(), sizeof(T), zero.size(), file);
+    }
+    _fseeki64(file, 0, SEEK_END);
+    if (static_cast<uint64_t>(_ftelli64(file)) != bytes)
+    {
+      fclose(file);
+      throw("Error!Tile file has wrong size");
+    }
+#endif
+  }
+  TTiledMatrix(const TTiledMatrix&) = delete;
+  TTiledMatrix& operator=(const TTiledMatrix&) = delete;
+  ~TTiledMatrix()
+  {
+#if defined(TTILED_POSIX)
+    close(fd);
+#else
+    fclose(file);
+#endif
+  }
+
+  size_t size() const noexcept { return n; }
+  size_t tile_size() const noexcept { return tile; }
+  size_t tiles() const noexcept { return nt; }
+
+  // обмен плитками (буфер на tile * tile элементов)
+  void read_tile(size_t ti, size_t tj, T* buf) const
+  {
+    read_bytes(buf, tile_elems() * sizeof(T), tile_offset(ti, tj));
+  }
+  void write_tile(size_t ti, size_t tj, const T* buf)
+  {
+    write_bytes(buf, tile_elems() * sizeof(T), tile_offset(ti, tj));
+  }
+
+  // доступ к отдельным элементам (по одному чтению/записи на элемент)
+  T get(size_t i, size_t j) const
+  {
+    if (i >= n || j >= n)
+      throw out_of_range("Index out of range");
+    T v;
+    read_bytes(&v, sizeof(T), tile_offset(i / tile, j / tile) + ((i % tile) * tile + j % tile) * sizeof(T));
+    return v;
+  }
+  void set(size_t i, size_t j, const T& v)
+  {
+    if (i >= n || j >= n)
+      throw out_of_range("Index out of range");
+    write_bytes(&v, sizeof(T), tile_offset(i / tile, j / tile) + ((i % tile) * tile + j % tile) * sizeof(T));
+  }
+
+  // обмен с обычными матрицами (n <= get_max_matrix_size())
+  void assign(const TDynamicMatrix<T>& m)
+  {
+    if (m.size() != n)
+      throw("Error");
+    vector<T> buf(tile_elems());
+    for (size_t ti = 0; ti < nt; ti++)
+      for (size_t tj = 0; tj < nt; tj++)
+      {
+        std::fill(buf.begin(), buf.end(), T());
+        for (size_t i = ti * tile; i < min(n, (ti + 1) * tile); i++)
+          for (size_t j = tj * tile; j < min(n, (tj + 1) * tile); j++)
+            buf[(i - ti * tile) * tile + j - tj * tile] = m[i][j];
+        write_tile(ti, tj, buf.data());
+      }
+  }
+  TDynamicMatrix<T> toDense() const
+  {
+    TDynamicMatrix<T> m(n);
+    vector<T> buf(tile_elems());
+    for (size_t ti = 0; ti < nt; ti++)
+      for (size_t tj = 0; tj < nt; tj++)
+      {
+        read_tile(ti, tj, buf.data());
+        for (size_t i = ti * tile; i < min(n, (ti + 1) * tile); i++)
+          for (size_t j = tj * tile; j < min(n, (tj + 1) * tile); j++)
+            m[i][j] = buf[(i - ti * tile) * tile + j - tj * tile];
+      }
+    return m;
+  }
+
+  // C = A * B по плиткам. Строка плиток A(ti, *) читается в память один раз
+  // (или частями по maxTiles - 3 плитки, если задан бюджет maxTiles плиток
+  // в памяти), и к ней по очереди подводятся столбцы плиток B(*, tj). Так
+  // каждая плитка A читается один раз, B - nt раз: nt^2 + nt^3 чтений вместо
+  // 2 nt^3 при чтении пары плиток на каждый шаг. При разбиении строки A на
+  // части частичные суммы C перечитываются с диска. Следующая плитка B
+  // читается потоком упреждающего чтения, пока считается текущая.
+  friend TTiledStats multiply(const TTiledMatrix& a, const TTiledMatrix& b, TTiledMatrix& c, size_t maxTiles = 0)
+  {
+    const size_t n = a.n, tile = a.tile, nt = a.nt, te = a.tile_elems();
+
+    TMATRIX_OP("gemm_tiled", n, 2 * n * n * n, (nt + 2) * n * n * sizeof(T));
+    if (b.n != n || c.n != n || b.tile != tile || c.tile != tile)
+      throw("Error");
+    if (&c == &a || &c == &b)
+      throw("Error!The result must not alias an operand");
+    // две плитки B и сумма C плюс хотя бы одна плитка A
+    if (maxTiles != 0 && maxTiles < 4)
+      throw out_of_range("Tile budget should be at least 4 tiles");
+    const size_t chunk = (maxTiles == 0) ? nt : min(nt, maxTiles - 3);
+
+    struct TStep { size_t ti, tj, tk; };
+    vector<TStep> steps;
+    steps.reserve(nt * nt * nt);
+    for (size_t ti = 0; ti < nt; ti++)
+      for (size_t k0 = 0; k0 < nt; k0 += chunk)
+        for (size_t tj = 0; tj < nt; tj++)
+          for (size_t tk = k0; tk < min(nt, k0 + chunk); tk++)
+            steps.push_back({ ti, tj, tk });
+
+    vector<T> rowA(chunk * te);
+    vector<T> bufB[2] = { vector<T>(te), vector<T>(te) };
+    vector<T> acc(te);
+    TTiledStats stats{ 0, 0 };
+    TTilePrefetcher prefetch;
+    size_t ticket = prefetch.submit(b, steps[0].tk, steps[0].tj, bufB[0].data());
+
+    for (size_t s = 0; s < steps.size(); s++)
+    {
+      const TStep& st = steps[s];
+      const size_t k0 = st.tk / chunk * chunk, k1 = min(nt, k0 + chunk);
+      const bool first = (st.tk == k0), last = (st.tk + 1 == k1);
+
+      // начало части строки A: её плитки читаются один раз, для следующих
+      // столбцов плиток C берутся из памяти
+      if (first && st.tj == 0)
+      {
+        for (size_t tk = k0; tk < k1; tk++)
+          a.read_tile(st.ti, tk, rowA.data() + (tk - k0) * te);
+        stats.loads += k1 - k0;
+      }
+      if (st.tj > 0)
+        stats.reuses++;
+      if (first)
+      {
+        if (k0 == 0)
+          std::fill(acc.begin(), acc.end(), T());
+        else
+        {
+          c.read_tile(st.ti, st.tj, acc.data());
+          stats.loads++;
+        }
+      }
+      const int cur = static_cast<int>(s % 2);
+      prefetch.wait(ticket);
+      stats.loads++;
+      if (s + 1 < steps.size())
+        ticket = prefetch.submit(b, steps[s + 1].tk, steps[s + 1].tj, bufB[1 - cur].data());
+
+      const T* pa = rowA.data() + (st.tk - k0) * te;
+      const T* pb = bufB[cur].data();
+      T* pc = acc.data();
+      parallel_for_range(0, tile, [=](size_t lo, size_t hi)
+      {
+        for (size_t i = lo; i < hi; i++)
+        {
+          T* r = pc + i * tile;
+          for (size_t k = 0; k < tile; k++)
+          {
+            const T aik = pa[i * tile + k];
+            const T* bk = pb + k * tile;
+            for (size_t j = 0; j < tile; j++)
+              r[j] += aik * bk[j];
+          }
+        }
+      }, tile * tile * tile < PARALLEL_TILE_WORK ? tile : ROW_GRAIN);
+      if (last)
+        c.write_tile(st.ti, st.tj, acc.data());
+    }
+    return stats;
+  }
+};
+
+#endif
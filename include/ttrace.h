@@ -0,0 +1,212 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Трассировка операций tmatrix.h в формате Chrome Trace / Perfetto
+//
+// При сборке с TMATRIX_TRACE каждая внешняя операция векторов и матриц
+// и каждый блок параллельного ядра пишут события начала/конца (имя, размер,
+// поток) в кольцевой буфер своего потока. Запись не блокируется: буфер
+// пишет только его поток, а trace_flush_json забирает накопленное.
+// При переполнении новые события отбрасываются (trace_dropped).
+// Во время работы трассировка включается set_tracing; выключенная стоит
+// одну атомарную проверку. Без TMATRIX_TRACE макрос TMATRIX_TRACE_OP пуст.
+
+#ifndef __TTrace_H__
+#define __TTrace_H__
+
+#ifdef TMATRIX_TRACE
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+const size_t TRACE_BUFFER_EVENTS = size_t(1) << 14;
+
+// Событие трассы
+struct TTraceEvent
+{
+  const char* name;   // строковый литерал операции
+  uint64_t ns;        // время от начала трассы
+  uint64_t n;         // размер операции
+  uint32_t tid;
+  char phase;         // 'B' - начало, 'E' - конец
+};
+
+// Кольцевой буфер одного потока: один писатель, один читатель
+class TTraceBuffer
+{
+  vector<TTraceEvent> events;
+  atomic<uint64_t> head{ 0 };   // следующая запись (меняет только писатель)
+  atomic<uint64_t> tail{ 0 };   // следующее чтение (меняет только читатель)
+public:
+  atomic<uint64_t> dropped{ 0 };
+
+  TTraceBuffer() : events(TRACE_BUFFER_EVENTS) {}
+
+  void push(const TTraceEvent& e) noexcept
+  {
+    const uint64_t h = head.load(memory_order_relaxed);
+    if (h - tail.load(memory_order_acquire) >= events.size())
+    {
+      dropped.fetch_add(1, memory_order_relaxed);
+      return;
+    }
+    events[h % events.size()] = e;
+    head.store(h + 1, memory_order_release);
+  }
+  template<typename F>
+  void drain(F f)
+  {
+    const uint64_t h = head.load(memory_order_acquire);
+    uint64_t t = tail.load(memory_order_relaxed);
+    for (; t < h; t++)
+      f(events[t % events.size()]);
+    tail.store(t, memory_order_release);
+  }
+};
+
+// Реестр буферов; буфер завершившегося потока отдаётся следующему новому,
+// поэтому короткоживущие рабочие потоки не плодят буферы
+class TTraceRegistry
+{
+  mutex mtx;
+  vector<unique_ptr<TTraceBuffer>> buffers;
+  vector<TTraceBuffer*> retired;
+  atomic<uint32_t> nextTid{ 1 };
+public:
+  atomic<bool> enabled{ false };
+  const chrono::steady_clock::time_point epoch = chrono::steady_clock::now();
+
+  static TTraceRegistry& instance()
+  {
+    static TTraceRegistry registry;
+    return registry;
+  }
+
+  TTraceBuffer* acquire()
+  {
+    lock_guard<mutex> guard(mtx);
+    if (!retired.empty())
+    {
+      TTraceBuffer* b = retired.back();
+      retired.pop_back();
+      return b;
+    }
+    buffers.emplace_back(new TTraceBuffer());
+    return buffers.back().get();
+  }
+  void retire(TTraceBuffer* b)
+  {
+    lock_guard<mutex> guard(mtx);
+    retired.push_back(b);
+  }
+  uint32_t new_tid() { return nextTid.fetch_add(1); }
+
+  template<typename F>
+  void drain_all(F f)
+  {
+    lock_guard<mutex> guard(mtx);
+    for (auto& b : buffers)
+      b->drain(f);
+  }
+  uint64_t dropped()
+  {
+    lock_guard<mutex> guard(mtx);
+    uint64_t d = 0;
+    for (auto& b : buffers)
+      d += b->dropped.load();
+    return d;
+  }
+};
+
+// Состояние трассировки текущего потока
+class TTraceThread
+{
+  TTraceBuffer* buf;
+public:
+  const uint32_t tid;
+  int depth = 0;
+
+  TTraceThread() : buf(TTraceRegistry::instance().acquire()), tid(TTraceRegistry::instance().new_tid()) {}
+  ~TTraceThread() { TTraceRegistry::instance().retire(buf); }
+
+  void emit(const char* name, uint64_t n, char phase) noexcept
+  {
+    uint64_t ns = static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(
+      chrono::steady_clock::now() - TTraceRegistry::instance().epoch).count());
+    buf->push(TTraceEvent{ name, ns, n, tid, phase });
+  }
+  static TTraceThread& local()
+  {
+    thread_local TTraceThread t;
+    return t;
+  }
+};
+
+// Пара событий начала/конца вокруг внешней операции потока (RAII)
+class TTraceScope
+{
+  const char* name;
+  uint64_t n;
+  bool counted;   // учтена глубина вложенности
+  bool active;    // записано событие начала
+public:
+  TTraceScope(const char* op, uint64_t size) : name(op), n(size), counted(false), active(false)
+  {
+    if (!TTraceRegistry::instance().enabled.load(memory_order_relaxed))
+      return;
+    TTraceThread& t = TTraceThread::local();
+    counted = true;
+    if (t.depth++ == 0)
+    {
+      active = true;
+      t.emit(name, n, 'B');
+    }
+  }
+  ~TTraceScope()
+  {
+    if (!counted)
+      return;
+    TTraceThread& t = TTraceThread::local();
+    t.depth--;
+    if (active)
+      t.emit(name, n, 'E');
+  }
+  TTraceScope(const TTraceScope&) = delete;
+  TTraceScope& operator=(const TTraceScope&) = delete;
+};
+
+inline void set_tracing(bool on) { TTraceRegistry::instance().enabled = on; }
+inline bool get_tracing() { return TTraceRegistry::instance().enabled; }
+inline uint64_t trace_dropped() { return TTraceRegistry::instance().dropped(); }
+
+// Выгрузка накопленных событий в формате Chrome Trace JSON
+// (открывается в chrome://tracing и ui.perfetto.dev); буферы очищаются
+inline void trace_flush_json(ostream& os)
+{
+  bool first = true;
+  os << "{\"traceEvents\": [";
+  TTraceRegistry::instance().drain_all([&](const TTraceEvent& e)
+  {
+    os << (first ? "\n" : ",\n") << "  {\"name\": \"" << e.name << "\", \"cat\": \"tmatrix\", \"ph\": \""
+      << e.phase << "\", \"ts\": " << e.ns / 1000 << '.' << (e.ns % 1000) / 100 << (e.ns % 100) / 10 << e.ns % 10
+      << ", \"pid\": 1, \"tid\": " << e.tid << ", \"args\": {\"n\": " << e.n << "}}";
+    first = false;
+  });
+  os << "\n], \"displayTimeUnit\": \"ns\"}\n";
+}
+
+#define TMATRIX_TRACE_OP(name, n) TTraceScope tmatrix_trace_scope_(name, n)
+
+#else
+
+#define TMATRIX_TRACE_OP(name, n)
+
+#endif
+
+#endif
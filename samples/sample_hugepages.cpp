@@ -0,0 +1,128 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Сравнение обычных и крупных страниц на случайном доступе к большому вектору
+//
+// Запуск: sample_hugepages [число элементов, по умолчанию 2^25]
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "tmatrix.h"
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#endif
+//---------------------------------------------------------------------------
+
+// счётчик промахов dTLB при чтении (-1, если недоступен)
+class TTlbCounter
+{
+  int fd = -1;
+public:
+  TTlbCounter()
+  {
+#ifdef __linux__
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+  }
+  ~TTlbCounter()
+  {
+#ifdef __linux__
+    if (fd >= 0)
+      close(fd);
+#endif
+  }
+  void start()
+  {
+#ifdef __linux__
+    if (fd >= 0)
+    {
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+  long long stop()
+  {
+    long long value = -1;
+#ifdef __linux__
+    if (fd >= 0)
+    {
+      ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(fd, &value, sizeof(value)) != sizeof(value))
+        value = -1;
+    }
+#endif
+    return value;
+  }
+};
+
+// объём памяти процесса в прозрачных крупных страницах, КиБ
+long long anon_huge_kb()
+{
+  ifstream smaps("/proc/self/smaps_rollup");
+  string key;
+  long long value;
+  while (smaps >> key)
+  {
+    if (key == "AnonHugePages:" && smaps >> value)
+      return value;
+    smaps.ignore(1 << 10, '\n');
+  }
+  return -1;
+}
+
+void run(const char* name, THugePages mode, size_t n)
+{
+  set_huge_pages(mode);
+  TDynamicVector<double> v(n);
+  for (size_t i = 0; i < n; i++)
+    v[i] = 1.0;
+
+  const double* p = static_cast<const TDynamicVector<double>&>(v).data();
+  TTlbCounter tlb;
+  unsigned long long x = 12345;
+  double sum = 0;
+
+  tlb.start();
+  auto t0 = chrono::steady_clock::now();
+  for (size_t i = 0; i < n; i++)
+  {
+    x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    sum += p[(x >> 20) % n];
+  }
+  auto t1 = chrono::steady_clock::now();
+  long long misses = tlb.stop();
+
+  cout << name << ": " << chrono::duration<double, milli>(t1 - t0).count() << " ms, dTLB misses ";
+  if (misses >= 0)
+    cout << misses;
+  else
+    cout << "n/a";
+  cout << ", AnonHugePages " << anon_huge_kb() << " KiB (sum " << sum << ")" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+  size_t n = (argc > 1) ? strtoull(argv[1], nullptr, 10) : (size_t(1) << 25);
+
+  cout << "Random reads over " << n << " doubles" << endl;
+  run("4 KiB pages     ", THugePages::None, n);
+  run("transparent 2MiB", THugePages::Transparent, n);
+  run("explicit 2MiB   ", THugePages::Explicit, n);
+  return 0;
+}
+//---------------------------------------------------------------------------
@@ -0,0 +1,67 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Скорость режимов суммирования скалярного произведения
+//
+// Запуск: sample_reduction [число элементов, по умолчанию 2^20]
+// Для каждого режима TReduction печатаются время одного dot и отношение
+// к простому циклу с одним накопителем (operator*), а также ошибка
+// относительно суммы в long double.
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include "tmatrix.h"
+//---------------------------------------------------------------------------
+
+// среднее время f() в наносекундах по серии повторов
+template<typename F>
+double time_ns(F f, int reps)
+{
+  f();
+  auto t0 = chrono::steady_clock::now();
+  for (int r = 0; r < reps; r++)
+    f();
+  auto t1 = chrono::steady_clock::now();
+  return chrono::duration<double, nano>(t1 - t0).count() / reps;
+}
+
+template<typename T>
+void run(const char* type, size_t n)
+{
+  TDynamicVector<T> x(n), y(n);
+  long double exact = 0;
+  for (size_t i = 0; i < n; i++)
+  {
+    x[i] = T(1.0 / (i % 1000 + 1));
+    y[i] = T((i % 7) - 3 + 0.25);
+    exact += (long double)x[i] * y[i];
+  }
+  const int reps = int(max<size_t>(5, (size_t(1) << 26) / n));
+  volatile T sink;
+  const double raw = time_ns([&] { sink = x * y; }, reps);
+
+  cout << type << ", n = " << n << '\n';
+  cout << "  mode        ns/dot    x raw   rel.error\n";
+  cout << "  raw     " << setw(10) << fixed << setprecision(0) << raw << "     1.00   "
+    << scientific << setprecision(2) << fabsl((x * y - exact) / exact) << '\n';
+  const pair<const char*, TReduction> modes[] = { { "naive", TReduction::Naive },
+    { "pairwise", TReduction::Pairwise }, { "kahan", TReduction::Kahan }, { "wide", TReduction::Wide } };
+  for (auto& m : modes)
+  {
+    const double ns = time_ns([&] { sink = x.dot(y, m.second); }, reps);
+    cout << "  " << left << setw(8) << m.first << right << setw(10) << fixed << setprecision(0) << ns
+      << setw(9) << setprecision(2) << ns / raw << "   " << scientific << setprecision(2)
+      << fabsl((x.dot(y, m.second) - exact) / exact) << '\n';
+  }
+  (void)sink;
+}
+
+int main(int argc, char* argv[])
+{
+  const size_t n = (argc > 1) ? strtoull(argv[1], nullptr, 10) : (size_t(1) << 20);
+
+  run<float>("float", n);
+  run<double>("double", n);
+  return 0;
+}
@@ -0,0 +1,61 @@
+﻿// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Roofline-отчёт по основным операциям tmatrix.h
+//
+// Запуск: sample_roofline [json|csv]
+// Без аргумента печатается roofline-таблица, иначе - сырые показатели.
+
+#define TMATRIX_PROFILE
+
+#include <iostream>
+#include <string>
+#include "tmatrix.h"
+//---------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+  const size_t vectorSizes[] = { size_t(1) << 16, size_t(1) << 22 };
+  const size_t matrixSizes[] = { 256, 1024 };
+
+  for (size_t n : vectorSizes)
+  {
+    TDynamicVector<double> x(n), y(n);
+    for (size_t i = 0; i < n; i++)
+      x[i] = 1.0 / (i + 1);
+    for (int rep = 0; rep < 10; rep++)
+    {
+      y.axpy(0.5, x);
+      y += x;
+      volatile double d = x * y;
+      (void)d;
+    }
+  }
+  for (size_t n : matrixSizes)
+  {
+    TDynamicMatrix<double> a(n), b(n), c(n);
+    TDynamicVector<double> v(n), r(n);
+    for (size_t i = 0; i < n; i++)
+    {
+      v[i] = 1.0;
+      for (size_t j = 0; j < n; j++)
+        a[i][j] = b[i][j] = 1.0 / (i + j + 1);
+    }
+    for (int rep = 0; rep < 10; rep++)
+    {
+      a.multiply_to(v, r);
+      a.transposed_multiply_to(v, r);
+      c += a;
+    }
+    a.multiply_to(b, c);
+  }
+
+  string mode = (argc > 1) ? argv[1] : "";
+  if (mode == "json")
+    profile_report_json(cout);
+  else if (mode == "csv")
+    profile_report_csv(cout);
+  else
+    profile_report_roofline(cout, measure_machine_roofline());
+  return 0;
+}
+//---------------------------------------------------------------------------
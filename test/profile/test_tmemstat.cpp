@@ -0,0 +1,119 @@
+#include "tasync.h"
+#include "tbatch.h"
+#include "tbitmatrix.h"
+
+#include <gtest.h>
+#include <sstream>
+
+TEST(TMemStat, counts_live_bytes_of_vector)
+{
+    TMemoryStats before = memory_stats();
+
+    {
+        TDynamicVector<double> v(1000);
+
+        TMemoryStats during = memory_stats();
+
+        EXPECT_EQ(during.liveBytes - before.liveBytes, 1000 * sizeof(double));
+        EXPECT_EQ(during.allocations - before.allocations, 1);
+        EXPECT_EQ(during.histogram[9] - before.histogram[9], 0);
+        EXPECT_EQ(during.histogram[12] - before.histogram[12], 1);
+    }
+
+    EXPECT_EQ(memory_stats().liveBytes, before.liveBytes);
+}
+
+TEST(TMemStat, peak_remembers_freed_temporaries)
+{
+    memory_reset_peak();
+
+    TMemoryStats before = memory_stats();
+
+    {
+        TDynamicVector<int> v(4096);
+    }
+
+    TMemoryStats after = memory_stats();
+
+    EXPECT_EQ(after.liveBytes, before.liveBytes);
+    EXPECT_GE(after.peakBytes - before.liveBytes, 4096 * sizeof(int));
+}
+
+TEST(TMemStat, thread_statistics_are_separate)
+{
+    TMemoryStats mine = thread_memory_stats();
+    uint64_t other = 0;
+
+    thread worker([&other]()
+    {
+        TDynamicVector<int> v(10);
+        other = thread_memory_stats().allocations;
+    });
+    worker.join();
+
+    EXPECT_EQ(other, 1);
+    EXPECT_EQ(thread_memory_stats().allocations, mine.allocations);
+}
+
+TEST(TMemStat, scope_attributes_peak_of_chained_temporaries)
+{
+    const size_t n = 50;
+
+    TDynamicMatrix<double> a(n), b(n), c(n);
+    int64_t peak;
+
+    {
+        TMemoryScope stage("chain");
+
+        TDynamicMatrix<double> r = a + b + c;
+
+        peak = stage.peak_bytes();
+        EXPECT_GE(stage.allocations(), 2 * (n + 1));
+    }
+
+    // результат и один промежуточный итог живут одновременно
+    EXPECT_GE(peak, static_cast<int64_t>(2 * n * n * sizeof(double)));
+
+    ostringstream os;
+
+    memory_stage_report(os);
+
+    EXPECT_NE(os.str().find("chain,1,"), string::npos);
+}
+
+TEST(TMemStat, counts_bit_matrix_and_batch_storage)
+{
+    TMemoryStats before = memory_stats();
+
+    {
+        TBitMatrix m(130);
+        TBatchedMatrix<float> b(4, 10);
+
+        TMemoryStats during = memory_stats();
+
+        EXPECT_EQ(during.liveBytes - before.liveBytes, 130 * 3 * sizeof(uint64_t) + 160 * sizeof(float));
+        EXPECT_EQ(during.allocations - before.allocations, 2);
+    }
+
+    EXPECT_EQ(memory_stats().liveBytes, before.liveBytes);
+}
+
+TEST(TMemStat, multiply_async_does_not_copy_cow_or_moved_operands_on_caller)
+{
+    TDynamicMatrix<double> a(300), b(300), c(300);
+
+    a.set_cow(true);
+    TMemoryStats before = thread_memory_stats();
+    TFuture<TDynamicMatrix<double>> shared = multiply_async(a, std::move(b));
+    TMemoryStats after = thread_memory_stats();
+
+    EXPECT_EQ(after.allocations, before.allocations);
+
+    // lvalue-операнды без COW копируются целиком: массив строк и 300 строк на каждый
+    before = thread_memory_stats();
+    TFuture<TDynamicMatrix<double>> copied = multiply_async(c, shared.get());
+    after = thread_memory_stats();
+
+    EXPECT_EQ(after.allocations - before.allocations, 2 * 301);
+    EXPECT_EQ(copied.get(), c);
+}
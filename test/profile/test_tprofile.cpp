@@ -0,0 +1,147 @@
+#include "tstream.h"
+
+#include <gtest.h>
+#include <sstream>
+
+TEST(TProfile, records_outer_operations_only)
+{
+    profile_reset();
+
+    TDynamicMatrix<int> m1(8), m2(8);
+
+    TDynamicMatrix<int> res = m1 * m2;
+    TDynamicMatrix<int> sum = m1 + m2;
+
+    auto table = TProfileRegistry::instance().snapshot();
+
+    ASSERT_EQ(table.size(), 2);
+    EXPECT_EQ((table[make_pair(string("gemm"), size_t(3))].calls), 1);
+    EXPECT_EQ((table[make_pair(string("matrix_add"), size_t(3))].calls), 1);
+}
+
+TEST(TProfile, groups_calls_by_size_bucket)
+{
+    profile_reset();
+
+    TDynamicVector<double> v5(5), v7(7), v9(9);
+
+    v5 * v5;
+    v7 * v7;
+    v9 * v9;
+
+    auto table = TProfileRegistry::instance().snapshot();
+
+    EXPECT_EQ((table[make_pair(string("dot"), size_t(2))].calls), 2);
+    EXPECT_EQ((table[make_pair(string("dot"), size_t(3))].calls), 1);
+}
+
+TEST(TProfile, can_dump_json_and_csv)
+{
+    profile_reset();
+
+    TDynamicVector<double> x(16), y(16);
+
+    y.axpy(2.0, x);
+
+    ostringstream json, csv;
+
+    profile_report_json(json);
+    profile_report_csv(csv);
+
+    EXPECT_NE(json.str().find("\"op\": \"axpy\""), string::npos);
+    EXPECT_NE(json.str().find("\"dtlb_misses\""), string::npos);
+    EXPECT_EQ(csv.str().find("op,bucket,min_size,calls,ns,flops,bytes,cycles,instructions,llc_misses,dtlb_misses\n"), 0);
+    EXPECT_NE(csv.str().find("axpy,4,16,1,"), string::npos);
+}
+
+TEST(TProfile, counts_flops_and_bytes_from_dimensions)
+{
+    profile_reset();
+
+    TDynamicMatrix<double> m1(10), m2(10);
+    TDynamicVector<double> v(10);
+
+    m1 * m2;
+    m1 * v;
+
+    auto table = TProfileRegistry::instance().snapshot();
+    TOpStats gemm = table[make_pair(string("gemm"), size_t(3))];
+    TOpStats gemv = table[make_pair(string("gemv"), size_t(3))];
+
+    EXPECT_EQ(gemm.flops, 2000);
+    EXPECT_EQ(gemm.bytes, 300 * sizeof(double));
+    EXPECT_EQ(gemv.flops, 200);
+    EXPECT_EQ(gemv.bytes, 120 * sizeof(double));
+}
+
+TEST(TProfile, roofline_report_classifies_kernels)
+{
+    profile_reset();
+
+    TDynamicMatrix<double> m1(64), m2(64);
+    TDynamicVector<double> x(64), y(64);
+
+    m1 * m2;
+    y.axpy(1.0, x);
+
+    TMachineRoofline machine = { 10.0, 10.0 };
+    ostringstream os;
+
+    profile_report_roofline(os, machine);
+
+    EXPECT_NE(os.str().find("axpy,6,64,1,"), string::npos);
+    EXPECT_NE(os.str().find(",memory,"), string::npos);
+    EXPECT_NE(os.str().find(",compute,"), string::npos);
+}
+
+TEST(TProfile, operations_in_worker_threads_are_nested_in_outer_one)
+{
+    profile_reset();
+    TNumThreadsGuard threads(8);
+
+    TDynamicVector<double> v(64);
+    {
+        TMATRIX_PROFILE_OP("outer", 1024, 0, 0);
+        parallel_for_range(0, 64, [&v](size_t lo, size_t hi)
+        {
+            for (size_t i = lo; i < hi; i++)
+            {
+                v * v;
+            }
+        });
+    }
+
+    auto table = TProfileRegistry::instance().snapshot();
+
+    ASSERT_EQ(table.size(), 1);
+    EXPECT_EQ((table[make_pair(string("outer"), size_t(10))].calls), 1);
+}
+
+TEST(TProfile, matrix_norm_is_recorded_once_with_several_threads)
+{
+    profile_reset();
+    TNumThreadsGuard threads(8);
+
+    TDynamicMatrix<double> m(1024);
+    m.norm_inf();
+
+    auto table = TProfileRegistry::instance().snapshot();
+
+    ASSERT_EQ(table.size(), 1);
+    EXPECT_EQ((table[make_pair(string("matrix_norm_inf"), size_t(10))].calls), 1);
+}
+
+TEST(TProfile, stream_stages_are_nested_in_stream_gemv)
+{
+    profile_reset();
+
+    TDynamicVector<double> x(16);
+    stringstream in, out;
+    in << TDynamicMatrix<double>(16);
+    stream_gemv(in, out, x, 16, [](TDynamicVector<double>& r) { r *= 2.0; }, 4);
+
+    auto table = TProfileRegistry::instance().snapshot();
+
+    ASSERT_EQ(table.size(), 1);
+    EXPECT_EQ((table[make_pair(string("stream_gemv"), size_t(4))].calls), 1);
+}
@@ -0,0 +1,100 @@
+#include "tmatrix.h"
+
+#include <gtest.h>
+#include <sstream>
+
+static size_t count_of(const string& text, const string& what)
+{
+    size_t count = 0;
+
+    for (size_t pos = text.find(what); pos != string::npos; pos = text.find(what, pos + 1))
+    {
+        count++;
+    }
+    return count;
+}
+
+TEST(TTrace, disabled_tracing_records_nothing)
+{
+    ostringstream drain;
+
+    trace_flush_json(drain);
+    set_tracing(false);
+
+    TDynamicVector<int> v(10);
+
+    v += v;
+
+    ostringstream os;
+
+    trace_flush_json(os);
+
+    EXPECT_EQ(count_of(os.str(), "\"name\""), 0);
+}
+
+TEST(TTrace, outer_operation_emits_begin_and_end)
+{
+    ostringstream drain;
+
+    trace_flush_json(drain);
+    set_tracing(true);
+
+    TDynamicMatrix<int> m1(5), m2(5);
+
+    m1 += m2;
+    set_tracing(false);
+
+    ostringstream os;
+
+    trace_flush_json(os);
+
+    EXPECT_EQ(count_of(os.str(), "\"name\": \"matrix_add_inplace\""), 2);
+    EXPECT_EQ(count_of(os.str(), "\"name\": \"vector_add_inplace\""), 0);
+    EXPECT_NE(os.str().find("\"ph\": \"B\""), string::npos);
+    EXPECT_NE(os.str().find("\"ph\": \"E\""), string::npos);
+    EXPECT_NE(os.str().find("\"args\": {\"n\": 5}"), string::npos);
+}
+
+TEST(TTrace, parallel_blocks_are_traced_on_worker_threads)
+{
+    ostringstream drain;
+
+    trace_flush_json(drain);
+    set_tracing(true);
+    TNumThreadsGuard threads(4);
+
+    TDynamicMatrix<double> a(200), b(200);
+    TDynamicMatrix<double> c = a * b;
+
+    set_tracing(false);
+
+    ostringstream os;
+
+    trace_flush_json(os);
+
+    EXPECT_EQ(count_of(os.str(), "\"name\": \"gemm\""), 2);
+    EXPECT_EQ(count_of(os.str(), "\"name\": \"parallel_block\""), 6);
+}
+
+TEST(TTrace, full_buffer_drops_events)
+{
+    ostringstream drain;
+
+    trace_flush_json(drain);
+
+    uint64_t dropped = trace_dropped();
+
+    set_tracing(true);
+
+    TDynamicVector<int> v(1);
+
+    for (size_t i = 0; i < TRACE_BUFFER_EVENTS; i++)
+    {
+        v *= 1;
+    }
+    set_tracing(false);
+
+    EXPECT_EQ(trace_dropped() - dropped, TRACE_BUFFER_EVENTS);
+
+    trace_flush_json(drain);
+}
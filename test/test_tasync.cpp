@@ -0,0 +1,147 @@
+#include "tasync.h"
+
+#include <gtest.h>
+
+static TDynamicMatrix<double> make_matrix(size_t n, double seed)
+{
+    TDynamicMatrix<double> m(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            m[i][j] = sin(seed + double(i * n + j));
+        }
+    }
+    return m;
+}
+
+TEST(TAsync, multiply_async_matches_multiply)
+{
+    TDynamicMatrix<double> a = make_matrix(60, 1), b = make_matrix(60, 2);
+    TFuture<TDynamicMatrix<double>> f = multiply_async(a, b);
+
+    EXPECT_EQ(f.get(), a * b);
+    EXPECT_TRUE(f.ready());
+}
+
+TEST(TAsync, operands_can_be_changed_after_submission)
+{
+    TDynamicMatrix<double> a = make_matrix(40, 1), b = make_matrix(40, 2);
+    TDynamicMatrix<double> expected = a * b;
+    TFuture<TDynamicMatrix<double>> f = multiply_async(a, b);
+
+    a[0][0] = 100;
+    b = make_matrix(40, 3);
+
+    EXPECT_EQ(f.get(), expected);
+}
+
+TEST(TAsync, cow_and_moved_operands_are_passed_without_changing_result)
+{
+    TDynamicMatrix<double> a = make_matrix(40, 1), b = make_matrix(40, 2);
+    TDynamicMatrix<double> expected = a * b;
+
+    a.set_cow(true);
+    TFuture<TDynamicMatrix<double>> f = multiply_async(a, make_matrix(40, 2));
+    a[0][0] = 100;
+
+    EXPECT_EQ(f.get(), expected);
+    EXPECT_EQ(multiply_async(make_matrix(40, 1), std::move(b)).get(), expected);
+}
+
+TEST(TAsync, matrix_vector_product_can_be_chained)
+{
+    TDynamicMatrix<double> a = make_matrix(50, 1);
+    TDynamicVector<double> x(50);
+
+    for (size_t i = 0; i < 50; i++)
+    {
+        x[i] = double(i % 3);
+    }
+    TFuture<double> f = multiply_async(a, x).then([](const TDynamicVector<double>& y) { return y.sum(); });
+
+    EXPECT_DOUBLE_EQ(f.get(), (a * x).sum());
+}
+
+TEST(TAsync, dependent_products_give_product_of_products)
+{
+    TDynamicMatrix<double> a = make_matrix(30, 1), b = make_matrix(30, 2);
+    TDynamicMatrix<double> c = make_matrix(30, 3), d = make_matrix(30, 4);
+    TFuture<TDynamicMatrix<double>> f = multiply_async(multiply_async(a, b), multiply_async(c, d));
+    TDynamicMatrix<double> ab = a * b, cd = c * d;
+
+    EXPECT_EQ(f.get(), ab * cd);
+}
+
+TEST(TAsync, pending_dependency_blocks_neither_caller_nor_pool)
+{
+    auto st = make_shared<TAsyncState<TDynamicMatrix<double>>>();
+    TFuture<TDynamicMatrix<double>> pending(st);
+    TFuture<TDynamicMatrix<double>> f = multiply_async(pending, pending);
+
+    // пока аргумент не готов, продолжение не занимает ни одного потока пула:
+    // в пуле успевают выполниться задачи сверх числа его потоков
+    vector<TFuture<int>> others;
+    for (size_t k = 0; k < 2 * async_pool().size() + 1; k++)
+    {
+        others.push_back(run_async([k]() { return int(k); }));
+    }
+    for (size_t k = 0; k < others.size(); k++)
+    {
+        EXPECT_EQ(others[k].get(), int(k));
+    }
+    EXPECT_FALSE(f.ready());
+
+    TDynamicMatrix<double> m = make_matrix(20, 1);
+    st->value.emplace(m);
+    st->finish();
+
+    EXPECT_EQ(f.get(), m * m);
+}
+
+TEST(TAsync, kernels_in_pool_tasks_run_single_threaded)
+{
+    TNumThreadsGuard threads(4);
+
+    TFuture<size_t> inside = run_async([]() { return get_num_threads(); });
+
+    EXPECT_EQ(inside.get(), 1);
+    EXPECT_EQ(get_num_threads(), 4);
+}
+
+TEST(TAsync, many_independent_jobs_complete)
+{
+    const size_t jobs = 32;
+    TDynamicMatrix<double> a = make_matrix(20, 1);
+    vector<TFuture<TDynamicMatrix<double>>> fs;
+
+    for (size_t k = 0; k < jobs; k++)
+    {
+        fs.push_back(multiply_async(a, make_matrix(20, double(k))));
+    }
+    for (size_t k = 0; k < jobs; k++)
+    {
+        EXPECT_EQ(fs[k].get(), a * make_matrix(20, double(k)));
+    }
+}
+
+TEST(TAsync, error_is_rethrown_by_get_and_skips_continuation)
+{
+    TDynamicMatrix<double> a(3), b(4);
+    bool called = false;
+    TFuture<TDynamicMatrix<double>> f = multiply_async(a, b);
+    TFuture<int> g = f.then([&called](const TDynamicMatrix<double>&) { called = true; return 1; });
+
+    ASSERT_ANY_THROW(f.get());
+    ASSERT_ANY_THROW(g.get());
+    EXPECT_FALSE(called);
+}
+
+TEST(TAsync, cant_wait_on_empty_future)
+{
+    TFuture<int> f;
+
+    EXPECT_FALSE(f.valid());
+    ASSERT_ANY_THROW(f.get());
+}
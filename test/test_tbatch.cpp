@@ -0,0 +1,143 @@
+#include "tbatch.h"
+
+#include <gtest.h>
+
+static TDynamicMatrix<int> make_test_matrix(size_t n, int seed)
+{
+    TDynamicMatrix<int> m(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            m[i][j] = static_cast<int>((i * 7 + j * 3 + seed) % 11) - 5;
+        }
+    }
+    return m;
+}
+
+// эталон - прямой тройной цикл, независимый от ядер библиотеки
+static TDynamicMatrix<int> naive_product(const TDynamicMatrix<int>& a, const TDynamicMatrix<int>& b)
+{
+    const size_t n = a.size();
+    TDynamicMatrix<int> c(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            int s = 0;
+            for (size_t k = 0; k < n; k++)
+            {
+                s += a[i][k] * b[k][j];
+            }
+            c[i][j] = s;
+        }
+    }
+    return c;
+}
+
+TEST(TBatchedMatrix, can_create_batch)
+{
+    ASSERT_NO_THROW(TBatchedMatrix<int> b(8, 100));
+}
+
+TEST(TBatchedMatrix, cant_create_empty_batch)
+{
+    ASSERT_ANY_THROW(TBatchedMatrix<int> b(8, 0));
+}
+
+TEST(TBatchedMatrix, set_and_get_keep_matrix)
+{
+    TDynamicMatrix<int> m = make_test_matrix(4, 1);
+
+    TBatchedMatrix<int> b(4, 3, TBatchLayout::Interleaved);
+
+    b.set(1, m);
+
+    EXPECT_EQ(b.get(1), m);
+}
+
+TEST(TBatchedMatrix, strided_batch_product_is_equal_to_single_products)
+{
+    const size_t n = 8, count = 37;
+
+    TBatchedMatrix<int> a(n, count), b(n, count), c(n, count);
+
+    for (size_t p = 0; p < count; p++)
+    {
+        a.set(p, make_test_matrix(n, static_cast<int>(p)));
+        b.set(p, make_test_matrix(n, static_cast<int>(p) + 5));
+    }
+    TNumThreadsGuard threads(4);
+    multiply(a, b, c);
+
+    for (size_t p = 0; p < count; p++)
+    {
+        EXPECT_EQ(c.get(p), naive_product(a.get(p), b.get(p)));
+    }
+}
+
+TEST(TBatchedMatrix, interleaved_batch_product_is_equal_to_single_products)
+{
+    const size_t n = 3, count = 150;
+
+    TBatchedMatrix<int> a(n, count, TBatchLayout::Interleaved);
+    TBatchedMatrix<int> b(n, count, TBatchLayout::Interleaved);
+    TBatchedMatrix<int> c(n, count, TBatchLayout::Interleaved);
+
+    for (size_t p = 0; p < count; p++)
+    {
+        a.set(p, make_test_matrix(n, static_cast<int>(p)));
+        b.set(p, make_test_matrix(n, static_cast<int>(p) + 2));
+    }
+    TNumThreadsGuard threads(4);
+    multiply(a, b, c);
+
+    for (size_t p = 0; p < count; p++)
+    {
+        EXPECT_EQ(c.get(p), naive_product(a.get(p), b.get(p)));
+    }
+}
+
+TEST(TBatchedMatrix, cant_multiply_batches_with_different_layout)
+{
+    TBatchedMatrix<int> a(4, 10), b(4, 10, TBatchLayout::Interleaved), c(4, 10);
+
+    ASSERT_ANY_THROW(multiply(a, b, c));
+}
+
+TEST(TBatchedMatrix, can_multiply_batch_of_dynamic_matrices)
+{
+    const size_t count = 10;
+
+    TDynamicMatrix<int> a[count], b[count], c[count];
+
+    for (size_t p = 0; p < count; p++)
+    {
+        a[p] = make_test_matrix(5 + p, static_cast<int>(p));
+        b[p] = make_test_matrix(5 + p, static_cast<int>(p) + 1);
+    }
+    multiply_batch(a, b, c, count);
+
+    for (size_t p = 0; p < count; p++)
+    {
+        EXPECT_EQ(c[p], naive_product(a[p], b[p]));
+    }
+}
+
+TEST(TBatchedMatrix, cant_write_batch_result_over_operand_array)
+{
+    const size_t count = 4;
+
+    TDynamicMatrix<int> a[count + 1], b[count];
+
+    for (size_t p = 0; p < count; p++)
+    {
+        a[p] = make_test_matrix(3, static_cast<int>(p));
+        b[p] = make_test_matrix(3, static_cast<int>(p) + 1);
+    }
+    a[count] = make_test_matrix(3, 0);
+
+    ASSERT_ANY_THROW(multiply_batch(a, b, a + 1, count));
+}
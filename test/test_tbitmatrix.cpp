@@ -0,0 +1,153 @@
+#include "tbitmatrix.h"
+
+#include <gtest.h>
+
+static TDynamicMatrix<int> make_adjacency(size_t n, int seed)
+{
+    TDynamicMatrix<int> m(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            m[i][j] = (i * 29 + j * 13 + seed) % 17 < 3;
+        }
+    }
+    return m;
+}
+
+TEST(TBitMatrix, can_create_bit_matrix)
+{
+    ASSERT_NO_THROW(TBitMatrix m(100));
+}
+
+TEST(TBitMatrix, cant_create_too_large_matrix)
+{
+    ASSERT_ANY_THROW(TBitMatrix m(MAX_MATRIX_SIZE + 1));
+}
+
+TEST(TBitMatrix, uses_one_bit_per_element)
+{
+    TBitMatrix m(130);
+
+    EXPECT_EQ(m.words_per_row(), 3);
+}
+
+TEST(TBitMatrix, can_set_and_get_element)
+{
+    TBitMatrix m(70);
+
+    m.set(3, 65, true);
+    m.set(3, 2, true);
+    m.set(3, 2, false);
+
+    EXPECT_TRUE(m.get(3, 65));
+    EXPECT_FALSE(m.get(3, 2));
+    EXPECT_EQ(m.count(), 1);
+}
+
+TEST(TBitMatrix, throws_when_index_is_out_of_range)
+{
+    TBitMatrix m(5);
+
+    ASSERT_ANY_THROW(m.set(5, 0, true));
+    ASSERT_ANY_THROW(m.get(0, 5));
+}
+
+TEST(TBitMatrix, dense_conversion_keeps_elements)
+{
+    TDynamicMatrix<int> a = make_adjacency(100, 1);
+
+    EXPECT_EQ(TBitMatrix(a).toDense<int>(), a);
+}
+
+TEST(TBitMatrix, can_apply_word_operations)
+{
+    TDynamicMatrix<int> a = make_adjacency(90, 1), b = make_adjacency(90, 2);
+    TBitMatrix x(a), y(b);
+    TDynamicMatrix<int> land = (x & y).toDense<int>();
+    TDynamicMatrix<int> lor = (x | y).toDense<int>();
+    TDynamicMatrix<int> lxor = (x ^ y).toDense<int>();
+
+    for (size_t i = 0; i < 90; i++)
+    {
+        for (size_t j = 0; j < 90; j++)
+        {
+            EXPECT_EQ(land[i][j], a[i][j] & b[i][j]);
+            EXPECT_EQ(lor[i][j], a[i][j] | b[i][j]);
+            EXPECT_EQ(lxor[i][j], a[i][j] ^ b[i][j]);
+        }
+    }
+}
+
+TEST(TBitMatrix, boolean_product_matches_semiring_product)
+{
+    TDynamicMatrix<int> a = make_adjacency(300, 3), b = make_adjacency(300, 4);
+
+    TNumThreadsGuard threads(4);
+    TBitMatrix p = TBitMatrix(a) * TBitMatrix(b);
+
+    EXPECT_EQ(p.toDense<int>(), semiring_multiply<TOrAnd<int>>(a, b));
+}
+
+TEST(TBitMatrix, transitive_closure_of_chain_reaches_all_later_vertices)
+{
+    const size_t n = 100;
+    TBitMatrix m(n);
+
+    for (size_t i = 0; i + 1 < n; i++)
+    {
+        m.set(i, i + 1, true);
+    }
+    TBitMatrix c = m.transitive_closure();
+
+    EXPECT_EQ(c.count(), n * (n - 1) / 2);
+    EXPECT_TRUE(c.get(0, n - 1));
+    EXPECT_FALSE(c.get(n - 1, 0));
+    EXPECT_FALSE(c.get(5, 5));
+}
+
+TEST(TBitMatrix, closure_of_cycle_is_full)
+{
+    const size_t n = 65;
+    TBitMatrix m(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        m.set(i, (i + 1) % n, true);
+    }
+
+    EXPECT_EQ(m.transitive_closure().count(), n * n);
+}
+
+TEST(TBitMatrix, can_count_ones_by_rows_and_columns)
+{
+    TDynamicMatrix<int> a = make_adjacency(80, 5);
+    TBitMatrix m(a);
+    TDynamicVector<size_t> rc = m.row_counts(), cc = m.col_counts();
+    size_t total = 0;
+
+    for (size_t i = 0; i < 80; i++)
+    {
+        size_t r = 0, c = 0, common = 0;
+        for (size_t j = 0; j < 80; j++)
+        {
+            r += a[i][j];
+            c += a[j][i];
+            common += a[i][j] & a[7][j];
+        }
+        EXPECT_EQ(rc[i], r);
+        EXPECT_EQ(cc[i], c);
+        EXPECT_EQ(m.common(i, 7), common);
+        total += r;
+    }
+    EXPECT_EQ(m.count(), total);
+}
+
+TEST(TBitMatrix, cant_combine_matrices_with_not_equal_size)
+{
+    TBitMatrix a(3), b(4);
+
+    ASSERT_ANY_THROW(a & b);
+    ASSERT_ANY_THROW(a * b);
+}
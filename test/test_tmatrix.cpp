@@ -504,3 +504,668 @@ TEST(TDynamicMatrix, cant_multiply_matrix_by_matrix_with_incorrect_size) {
 
     ASSERT_ANY_THROW(original_matrix * multiplier_matrix);
 }
+
+TEST(TDynamicMatrix, multiply_to_reuses_result_matrix)
+{
+    const int size = 3;
+
+    TDynamicMatrix<int> m1(size), m2(size), res(size);
+
+    for (int i = 0; i < size; i++)
+    {
+        for (int j = 0; j < size; j++)
+        {
+            m1[i][j] = i + j;
+            m2[i][j] = i - j;
+        }
+    }
+    res[0][0] = 100;
+
+    m1.multiply_to(m2, res);
+
+    EXPECT_EQ(res, m1 * m2);
+}
+
+TEST(TDynamicMatrix, cant_multiply_to_operand)
+{
+    TDynamicMatrix<int> m1(3), m2(3);
+
+    ASSERT_ANY_THROW(m1.multiply_to(m2, m1));
+}
+
+TEST(TDynamicMatrix, parallel_product_is_equal_to_serial_one)
+{
+    const int size = 200;
+
+    TDynamicMatrix<int> m1(size), m2(size), res(size);
+
+    for (int i = 0; i < size; i++)
+    {
+        for (int j = 0; j < size; j++)
+        {
+            m1[i][j] = (i * 3 + j) % 7;
+            m2[i][j] = (i + j * 5) % 9;
+        }
+    }
+    m1.multiply_rows(m2, res, 0, size);
+
+    TNumThreadsGuard threads(4);
+    TDynamicMatrix<int> par = m1 * m2;
+
+    EXPECT_EQ(par, res);
+}
+
+TEST(TDynamicMatrix, blocked_product_by_vector_is_correct_for_odd_size)
+{
+    const int size = 7;
+
+    TDynamicMatrix<int> m(size);
+    TDynamicVector<int> v(size), expected(size);
+
+    for (int i = 0; i < size; i++)
+    {
+        v[i] = i - 3;
+        for (int j = 0; j < size; j++)
+        {
+            m[i][j] = i * size + j;
+        }
+    }
+    for (int i = 0; i < size; i++)
+    {
+        for (int j = 0; j < size; j++)
+        {
+            expected[i] += m[i][j] * v[j];
+        }
+    }
+
+    EXPECT_EQ(m * v, expected);
+}
+
+TEST(TDynamicMatrix, can_multiply_vector_by_matrix)
+{
+    const int size = 6;
+
+    TDynamicMatrix<int> m(size);
+    TDynamicVector<int> x(size), expected(size);
+
+    for (int i = 0; i < size; i++)
+    {
+        x[i] = 2 * i - 5;
+        for (int j = 0; j < size; j++)
+        {
+            m[i][j] = (i + 1) * (j + 2) % 5;
+        }
+    }
+    for (int j = 0; j < size; j++)
+    {
+        for (int i = 0; i < size; i++)
+        {
+            expected[j] += x[i] * m[i][j];
+        }
+    }
+
+    EXPECT_EQ(x * m, expected);
+}
+
+TEST(TDynamicMatrix, parallel_product_by_vector_is_equal_to_serial_one)
+{
+    const int size = 600;
+
+    TDynamicMatrix<int> m(size);
+    TDynamicVector<int> v(size), serial(size), serial_t(size);
+
+    for (int i = 0; i < size; i++)
+    {
+        v[i] = i % 13 - 6;
+        for (int j = 0; j < size; j++)
+        {
+            m[i][j] = (i * 5 + j * 3) % 17;
+        }
+    }
+    m.multiply_rows(v, serial, 0, size);
+    TNumThreadsGuard threads(1);
+    m.transposed_multiply_to(v, serial_t);
+
+    set_num_threads(4);
+    TDynamicVector<int> par = m * v;
+    TDynamicVector<int> par_t = v * m;
+
+    EXPECT_EQ(par, serial);
+    EXPECT_EQ(par_t, serial_t);
+}
+
+TEST(TDynamicMatrix, compound_operations_are_equal_to_binary_ones)
+{
+    const int size = 3;
+
+    TDynamicMatrix<int> m1(size), m2(size);
+
+    for (int i = 0; i < size; i++)
+    {
+        for (int j = 0; j < size; j++)
+        {
+            m1[i][j] = i * size + j;
+            m2[i][j] = j - i;
+        }
+    }
+    TDynamicMatrix<int> sum = m1 + m2, diff = m1 - m2, scaled = m1 * 4;
+
+    TDynamicMatrix<int> acc(m1);
+    acc += m2;
+    EXPECT_EQ(acc, sum);
+
+    acc = m1;
+    acc -= m2;
+    EXPECT_EQ(acc, diff);
+
+    acc = m1;
+    acc *= 4;
+    EXPECT_EQ(acc, scaled);
+
+    acc = m1;
+    acc.axpy(3, m1);
+    EXPECT_EQ(acc, scaled);
+}
+
+TEST(TDynamicMatrix, cant_add_matrix_with_not_equal_size_in_place)
+{
+    TDynamicMatrix<int> m1(3), m2(4);
+
+    ASSERT_ANY_THROW(m1 += m2);
+}
+
+TEST(TDynamicMatrix, cow_copy_detaches_only_changed_row)
+{
+    TDynamicMatrix<int> m1(3);
+
+    m1[1][1] = 5;
+    m1.set_cow(true);
+
+    TDynamicMatrix<int> m2(m1);
+
+    EXPECT_TRUE(m1.is_shared());
+
+    m2[1][1] = 6;
+
+    const TDynamicMatrix<int>& c1 = m1;
+    const TDynamicMatrix<int>& c2 = m2;
+
+    EXPECT_EQ(m1[1][1], 5);
+    EXPECT_EQ(m2[1][1], 6);
+    EXPECT_EQ(c1[0].data(), c2[0].data());
+    EXPECT_NE(c1[1].data(), c2[1].data());
+}
+
+TEST(TDynamicMatrix, cow_copy_is_not_changed_through_earlier_reference)
+{
+    TDynamicMatrix<int> m(3);
+
+    m.set_cow(true);
+    int& r = m[1][2];
+    TDynamicMatrix<int> c(m);
+    r = 42;
+
+    EXPECT_EQ(m[1][2], 42);
+    EXPECT_EQ(c[1][2], 0);
+}
+
+TEST(TDynamicMatrix, cow_copy_can_be_used_as_product_result)
+{
+    TDynamicMatrix<int> m(3), id(3);
+
+    for (int i = 0; i < 3; i++)
+    {
+        id[i][i] = 1;
+        m[i][0] = i + 1;
+    }
+    m.set_cow(true);
+
+    TDynamicMatrix<int> res(m);
+
+    id.multiply_to(id, res);
+
+    EXPECT_EQ(res, id);
+    EXPECT_EQ(m[2][0], 3);
+}
+
+TEST(TDynamicMatrix, can_create_matrix_with_numa_policy)
+{
+    const int size = 100;
+
+    TNumThreadsGuard threads(4);
+    TDynamicMatrix<double> first(size, TNumaPolicy::FirstTouch);
+    TDynamicMatrix<double> interleaved(size, TNumaPolicy::Interleave);
+    TDynamicMatrix<double> bound(size, TNumaPolicy::Bind, 0);
+    TDynamicMatrix<double> zero(size);
+
+    EXPECT_EQ(first, zero);
+    EXPECT_EQ(interleaved, zero);
+    EXPECT_EQ(bound, zero);
+}
+
+TEST(TDynamicMatrix, missing_numa_node_falls_back_to_default_placement)
+{
+    ASSERT_NO_THROW(TDynamicMatrix<int> m(10, TNumaPolicy::Bind, 63));
+}
+
+TEST(TDynamicMatrix, can_sum_elements)
+{
+    const int size = 10;
+    TDynamicMatrix<int> m(size);
+
+    for (int i = 0; i < size; i++)
+    {
+        for (int j = 0; j < size; j++)
+        {
+            m[i][j] = i * size + j;
+        }
+    }
+
+    EXPECT_EQ(m.sum(), 4950);
+    EXPECT_EQ(m.sum(TReduction::Naive), 4950);
+}
+
+TEST(TDynamicMatrix, parallel_sum_does_not_depend_on_thread_count)
+{
+    const int size = 600;
+    TDynamicMatrix<double> m(size);
+
+    for (int i = 0; i < size; i++)
+    {
+        for (int j = 0; j < size; j++)
+        {
+            m[i][j] = sin(i * size + j) * 1e3;
+        }
+    }
+
+    TNumThreadsGuard threads(1);
+    double pairwise = m.sum(TReduction::Pairwise);
+    double kahan = m.sum(TReduction::Kahan);
+    set_num_threads(4);
+
+    EXPECT_EQ(m.sum(TReduction::Pairwise), pairwise);
+    EXPECT_EQ(m.sum(TReduction::Kahan), kahan);
+}
+
+TEST(TDynamicMatrix, can_compute_norms)
+{
+    TDynamicMatrix<double> m(2);
+
+    m[0][0] = 1;
+    m[0][1] = -2;
+    m[1][0] = -3;
+    m[1][1] = 4;
+
+    EXPECT_DOUBLE_EQ(m.norm1(), 6.0);
+    EXPECT_DOUBLE_EQ(m.norm_inf(), 7.0);
+    EXPECT_DOUBLE_EQ(m.frobenius_norm(), sqrt(30.0));
+    EXPECT_DOUBLE_EQ(m.mean(), 0.0);
+}
+
+TEST(TDynamicMatrix, can_find_extreme_elements)
+{
+    const int size = 50;
+    TDynamicMatrix<int> m(size);
+
+    m[10][20] = 7;
+    m[30][5] = 7;
+    m[40][40] = -3;
+
+    EXPECT_EQ(m.argmax(), make_pair(size_t(10), size_t(20)));
+    EXPECT_EQ(m.argmin(), make_pair(size_t(40), size_t(40)));
+    EXPECT_EQ(m.max_value(), 7);
+    EXPECT_EQ(m.min_value(), -3);
+}
+
+TEST(TDynamicMatrix, row_and_column_reductions_match_element_loops)
+{
+    const int size = 700;
+    TDynamicMatrix<int> m(size);
+
+    for (int i = 0; i < size; i++)
+    {
+        for (int j = 0; j < size; j++)
+        {
+            m[i][j] = (i * 7 + j * 3) % 11 - 5;
+        }
+    }
+    TNumThreadsGuard threads(4);
+    TDynamicVector<int> rs = m.row_sums(), cs = m.col_sums();
+    TDynamicVector<int> rm = m.row_max(), cm = m.col_max();
+    TDynamicVector<int> rn = m.row_min(), cn = m.col_min();
+
+    for (int i = 0; i < size; i++)
+    {
+        int rsum = 0, csum = 0, rmax = m[i][0], cmax = m[0][i], rmin = m[i][0], cmin = m[0][i];
+        for (int j = 0; j < size; j++)
+        {
+            rsum += m[i][j];
+            csum += m[j][i];
+            rmax = max(rmax, m[i][j]);
+            cmax = max(cmax, m[j][i]);
+            rmin = min(rmin, m[i][j]);
+            cmin = min(cmin, m[j][i]);
+        }
+        EXPECT_EQ(rs[i], rsum);
+        EXPECT_EQ(cs[i], csum);
+        EXPECT_EQ(rm[i], rmax);
+        EXPECT_EQ(cm[i], cmax);
+        EXPECT_EQ(rn[i], rmin);
+        EXPECT_EQ(cn[i], cmin);
+    }
+}
+
+TEST(TDynamicMatrix, can_map_and_zip_elements)
+{
+    const int size = 600;
+    TDynamicMatrix<int> a(size), b(size);
+
+    for (int i = 0; i < size; i++)
+    {
+        for (int j = 0; j < size; j++)
+        {
+            a[i][j] = i - j;
+            b[i][j] = 2;
+        }
+    }
+    TNumThreadsGuard threads(4);
+    TDynamicMatrix<int> h = hadamard(a, b);
+    TDynamicMatrix<int> f = zip([](int x, int y, int z) { return x * y - z; }, a, b, h);
+    TDynamicMatrix<int> m = abs(a).map([](int x) { return -x; });
+
+    EXPECT_EQ(h[1][5], -8);
+    EXPECT_EQ(f[7][3], 0);
+    EXPECT_EQ(m[3][9], -6);
+    EXPECT_EQ(clamp(a, -1, 1)[0][size - 1], -1);
+}
+
+TEST(TDynamicMatrix, apply_detaches_cow_copy)
+{
+    TDynamicMatrix<int> m(3);
+
+    m.set_cow(true);
+    TDynamicMatrix<int> c(m);
+    c.apply([](int x) { return x + 1; });
+
+    EXPECT_EQ(m[0][0], 0);
+    EXPECT_EQ(c[0][0], 1);
+}
+
+TEST(TDynamicMatrix, cant_zip_matrices_with_not_equal_size)
+{
+    TDynamicMatrix<int> m1(3), m2(4);
+
+    ASSERT_ANY_THROW(hadamard(m1, m2));
+}
+
+TEST(TDynamicMatrix, pow_matches_repeated_multiplication)
+{
+    const int size = 5;
+    TDynamicMatrix<long long> m(size), expected(size);
+
+    for (int i = 0; i < size; i++)
+    {
+        for (int j = 0; j < size; j++)
+        {
+            m[i][j] = (i + 2 * j) % 3 - 1;
+        }
+        expected[i][i] = 1;
+    }
+    for (int p = 0; p < 13; p++)
+    {
+        expected = expected * m;
+    }
+
+    EXPECT_EQ(pow(m, 13), expected);
+}
+
+TEST(TDynamicMatrix, zero_power_is_identity)
+{
+    TDynamicMatrix<int> m(3), id(3);
+
+    for (int i = 0; i < 3; i++)
+    {
+        m[i][0] = 7;
+        id[i][i] = 1;
+    }
+
+    EXPECT_EQ(pow(m, 0), id);
+    EXPECT_EQ(pow(m, 1), m);
+}
+
+TEST(TDynamicMatrix, pow_mod_computes_large_fibonacci_number)
+{
+    TDynamicMatrix<long long> f(2);
+
+    f[0][0] = 1;
+    f[0][1] = 1;
+    f[1][0] = 1;
+
+    // F(10^18) mod (10^9 + 7)
+    EXPECT_EQ(pow_mod(f, 1000000000000000000ULL, 1000000007LL)[0][1], 209783453);
+}
+
+TEST(TDynamicMatrix, pow_mod_matches_pow_for_small_exponent)
+{
+    const int size = 40;
+    const long long mod = 1000003;
+    TDynamicMatrix<long long> m(size);
+
+    for (int i = 0; i < size; i++)
+    {
+        for (int j = 0; j < size; j++)
+        {
+            m[i][j] = (i * 5 + j) % 4;
+        }
+    }
+    TDynamicMatrix<long long> p = pow(m, 5);
+
+    for (int i = 0; i < size; i++)
+    {
+        for (int j = 0; j < size; j++)
+        {
+            p[i][j] %= mod;
+        }
+    }
+
+    EXPECT_EQ(pow_mod(m, 5, mod), p);
+}
+
+TEST(TDynamicMatrix, pow_mod_throws_for_invalid_modulus)
+{
+    TDynamicMatrix<long long> m(2);
+
+    ASSERT_ANY_THROW(pow_mod(m, 3, 0LL));
+}
+
+TEST(TDynamicMatrix, lazy_modular_product_is_exact_for_large_modulus)
+{
+    const int size = 50;
+    const long long mod = 4294967291LL; //   < 2^32
+    TDynamicMatrix<long long> a(size), b(size), res(size);
+
+    for (int i = 0; i < size; i++)
+    {
+        for (int j = 0; j < size; j++)
+        {
+            a[i][j] = mod - 1 - (i * j) % 7;
+            b[i][j] = mod - 1 - (i + j) % 5;
+        }
+    }
+    a.multiply_mod_to(b, res, mod);
+
+    for (int i = 0; i < size; i++)
+    {
+        for (int j = 0; j < size; j++)
+        {
+            unsigned long long s = 0;
+            for (int k = 0; k < size; k++)
+            {
+                s = (s + (unsigned long long)(a[i][k] % mod) * (unsigned long long)(b[k][j] % mod) % mod) % mod;
+            }
+            EXPECT_EQ(res[i][j], (long long)s);
+        }
+    }
+}
+
+TEST(TDynamicMatrix, det_mod_of_vandermonde_matrix_is_product_of_differences)
+{
+    const int size = 6;
+    const long long p = 1000000007;
+    TDynamicMatrix<long long> v(size);
+
+    for (int i = 0; i < size; i++)
+    {
+        long long x = 1;
+        for (int j = 0; j < size; j++)
+        {
+            v[i][j] = x;
+            x *= i + 1;
+        }
+    }
+
+    // 1! * 2! * 3! * 4! * 5!
+    EXPECT_EQ(det_mod(v, p), 34560);
+}
+
+TEST(TDynamicMatrix, det_mod_handles_row_swaps_and_negative_elements)
+{
+    const long long p = 998244353;
+    TDynamicMatrix<long long> m(2);
+
+    m[0][0] = 0;
+    m[0][1] = -1;
+    m[1][0] = 1;
+    m[1][1] = 5;
+
+    EXPECT_EQ(det_mod(m, p), 1);
+    m[0][1] = 1;
+    EXPECT_EQ(det_mod(m, p), p - 1);
+}
+
+TEST(TDynamicMatrix, det_mod_of_singular_matrix_is_zero)
+{
+    TDynamicMatrix<long long> m(3);
+
+    for (int j = 0; j < 3; j++)
+    {
+        m[0][j] = j + 1;
+        m[1][j] = 2 * (j + 1);
+        m[2][j] = j * j;
+    }
+
+    EXPECT_EQ(det_mod(m, 7LL), 0);
+}
+
+TEST(TDynamicMatrix, det_mod_throws_when_pivot_is_not_invertible)
+{
+    TDynamicMatrix<long long> m(2);
+    m[0][0] = 2; m[0][1] = 1;
+    m[1][0] = 1; m[1][1] = 1;
+
+    EXPECT_EQ(det_mod(m, 5LL), 1);
+    ASSERT_ANY_THROW(det_mod(m, 4LL));
+}
+
+TEST(TDynamicMatrix, size_limit_can_be_changed_at_runtime)
+{
+    set_max_matrix_size(5);
+    EXPECT_THROW(TDynamicMatrix<int> m(6), out_of_range);
+    set_max_matrix_size(MAX_MATRIX_SIZE);
+
+    EXPECT_NO_THROW(TDynamicMatrix<int> m(6));
+}
+
+TEST(TDynamicMatrix, throws_before_allocation_when_byte_size_overflows)
+{
+    //      :    
+    //  s * s * sizeof(T)
+    set_max_matrix_size(SIZE_MAX);
+    set_max_vector_size(SIZE_MAX);
+    string what;
+    try
+    {
+        TDynamicMatrix<double> m(size_t(1) << 32);
+    }
+    catch (const out_of_range& e)
+    {
+        what = e.what();
+    }
+    set_max_vector_size(MAX_VECTOR_SIZE);
+    set_max_matrix_size(MAX_MATRIX_SIZE);
+
+    EXPECT_EQ(what, "size_overflow");
+}
+
+TEST(TDynamicMatrix, pow_mod_reduces_entries_of_base)
+{
+    TDynamicMatrix<long long> m(2);
+
+    m[0][0] = -1;
+    m[0][1] = 10;
+    m[1][0] = 3;
+    m[1][1] = 20;
+    TDynamicMatrix<long long> r = pow_mod(m, 1, 7LL);
+
+    EXPECT_EQ(r[0][0], 6);
+    EXPECT_EQ(r[0][1], 3);
+    EXPECT_EQ(r[1][0], 3);
+    EXPECT_EQ(r[1][1], 6);
+}
+
+TEST(TDynamicMatrix, pow_mod_of_unreduced_matrix_equals_pow_mod_of_reduced_one)
+{
+    const size_t size = 40;
+    const long long p = 1000000007LL;
+    TDynamicMatrix<long long> m(size), reduced(size);
+
+    for (size_t i = 0; i < size; i++)
+    {
+        for (size_t j = 0; j < size; j++)
+        {
+            const long long x = (long long)((i * 131 + j * 71) % 97) * 45000000007LL - 2000000000000LL;
+            m[i][j] = x;
+            reduced[i][j] = ((x % p) + p) % p;
+        }
+    }
+
+    EXPECT_EQ(pow_mod(m, 37, p), pow_mod(reduced, 37, p));
+}
+
+TEST(TDynamicMatrix, column_sums_support_reduction_modes)
+{
+    const size_t size = 3000;
+    TDynamicMatrix<float> m(size);
+
+    for (size_t i = 0; i < size; i++)
+    {
+        for (size_t j = 0; j < size; j++)
+        {
+            m[i][j] = 0.1f + 1e-3f * static_cast<float>(j % 7);
+        }
+    }
+    TDynamicVector<float> naive = m.col_sums(TReduction::Naive);
+    TDynamicVector<float> pairwise = m.col_sums(TReduction::Pairwise);
+    TDynamicVector<float> kahan = m.col_sums(TReduction::Kahan);
+    TDynamicVector<float> wide = m.col_sums(TReduction::Wide);
+    TDynamicVector<float> single;
+    {
+        TNumThreadsGuard threads(1);
+        single = m.col_sums(TReduction::Pairwise);
+    }
+
+    EXPECT_EQ(single, pairwise);
+    double naiveError = 0;
+    for (size_t j = 0; j < size; j += 101)
+    {
+        const double exact = static_cast<double>(m[0][j]) * size;
+        const double tol = 4 * exact * numeric_limits<float>::epsilon();
+
+        naiveError = max(naiveError, fabs(naive[j] - exact) / tol);
+        EXPECT_LE(fabs(pairwise[j] - exact), tol);
+        EXPECT_LE(fabs(kahan[j] - exact), tol);
+        EXPECT_LE(fabs(wide[j] - exact), tol);
+    }
+    EXPECT_GT(naiveError, 1.0);
+    EXPECT_FLOAT_EQ(m.norm1(TReduction::Kahan), kahan.max_value());
+}
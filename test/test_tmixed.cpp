@@ -0,0 +1,169 @@
+#include "tmixed.h"
+
+#include <gtest.h>
+
+// диагонально преобладающая матрица (хорошо обусловлена)
+template<typename T>
+static TDynamicMatrix<T> make_system(size_t n)
+{
+    TDynamicMatrix<T> m(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            m[i][j] = static_cast<T>(sin(double(i * n + j)) / n);
+        }
+        m[i][i] += 2;
+    }
+    return m;
+}
+
+TEST(TBFloat16, keeps_exactly_representable_values)
+{
+    EXPECT_EQ(float(TBFloat16(1.0f)), 1.0f);
+    EXPECT_EQ(float(TBFloat16(-0.5f)), -0.5f);
+    EXPECT_EQ(float(TBFloat16(384.0f)), 384.0f);
+}
+
+TEST(TBFloat16, rounds_to_nearest_with_relative_error_below_2_to_minus_8)
+{
+    const float x = 1.0f / 3.0f;
+
+    EXPECT_NEAR(float(TBFloat16(x)), x, x / 256);
+    EXPECT_TRUE(float(TBFloat16(NAN)) != float(TBFloat16(NAN)));
+}
+
+TEST(TMixed, float_gemv_with_double_accumulation_matches_double_gemv)
+{
+    const size_t n = 600;
+    TDynamicMatrix<float> a = make_system<float>(n);
+    TDynamicMatrix<double> ad(n);
+    TDynamicVector<float> x(n);
+    TDynamicVector<double> xd(n), y, yd(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        x[i] = static_cast<float>(cos(double(i)));
+        xd[i] = x[i];
+        for (size_t j = 0; j < n; j++)
+        {
+            ad[i][j] = a[i][j];
+        }
+    }
+    TNumThreadsGuard threads(4);
+    mixed_multiply_to(a, x, y);
+    ad.multiply_to(xd, yd);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        EXPECT_NEAR(y[i], yd[i], 1e-12);
+    }
+}
+
+TEST(TMixed, bfloat16_gemm_with_float_accumulation_matches_float_gemm)
+{
+    const size_t n = 64;
+    TDynamicMatrix<float> a = make_system<float>(n), b = make_system<float>(n);
+    TDynamicMatrix<TBFloat16> ah(n), bh(n);
+    TDynamicMatrix<float> c;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            ah[i][j] = a[i][j];
+            bh[i][j] = b[i][j];
+            a[i][j] = ah[i][j];
+            b[i][j] = bh[i][j];
+        }
+    }
+    mixed_multiply_to(ah, bh, c);
+    TDynamicMatrix<float> expected = a * b;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            EXPECT_NEAR(c[i][j], expected[i][j], 1e-5);
+        }
+    }
+}
+
+TEST(TMixed, cant_multiply_matrices_with_not_equal_size)
+{
+    TDynamicMatrix<float> a(3), b(4);
+    TDynamicMatrix<double> c(3);
+
+    ASSERT_ANY_THROW(mixed_multiply_to(a, b, c));
+}
+
+TEST(TLUFactor, solves_system_in_working_precision)
+{
+    const size_t n = 50;
+    TDynamicMatrix<double> a = make_system<double>(n);
+    TDynamicVector<double> x(n), b(n), y;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        x[i] = double(i % 5) - 2;
+    }
+    a.multiply_to(x, b);
+    TLUFactor<double>(a).solve(b, y);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        EXPECT_NEAR(y[i], x[i], 1e-12);
+    }
+}
+
+TEST(TLUFactor, throws_for_singular_matrix)
+{
+    TDynamicMatrix<float> a(3);
+
+    ASSERT_ANY_THROW(TLUFactor<float> lu(a));
+}
+
+TEST(TMixed, refinement_reaches_double_accuracy_with_float_factorization)
+{
+    const size_t n = 300;
+    TDynamicMatrix<double> a = make_system<double>(n);
+    TDynamicVector<double> expected(n), b(n), x(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        expected[i] = 1.0 / (i + 1);
+    }
+    a.multiply_to(expected, b);
+
+    TSolverResult r = refine_solve<float>(a, b, x);
+
+    EXPECT_TRUE(r.converged);
+    EXPECT_LE(r.residual, 1e-12);
+    EXPECT_GT(r.iterations, 1);
+    for (size_t i = 0; i < n; i++)
+    {
+        EXPECT_NEAR(x[i], expected[i], 1e-12);
+    }
+}
+
+TEST(TMixed, refinement_converges_when_residual_shrinks_slower_than_twice_per_step)
+{
+    // в float строка 1 округляется так, что cond(A) * eps(float) ~ 0.65:
+    // невязка уменьшается примерно в 1.5 раза за итерацию
+    const double h = ldexp(1.0, -23);
+    TDynamicMatrix<double> a(2);
+    TDynamicVector<double> b(2), x(2);
+    a[0][0] = 1;
+    a[0][1] = 1;
+    a[1][0] = 1 - 0.2 * h;
+    a[1][1] = 1 + 1.45 * h;
+    b[0] = 1;
+    b[1] = 2;
+
+    TSolverResult r = refine_solve<float>(a, b, x, 100);
+
+    EXPECT_TRUE(r.converged);
+    EXPECT_LE(r.residual, 1e-12);
+    EXPECT_GT(r.iterations, 20);
+}
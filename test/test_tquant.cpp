@@ -0,0 +1,147 @@
+#include "tquant.h"
+
+#include <gtest.h>
+
+// псевдослучайное число из [-1, 1)
+static float noise(size_t i)
+{
+    return static_cast<float>((i * 2654435761u) % 2000) / 1000 - 1;
+}
+
+static TDynamicMatrix<float> make_weights(size_t n, size_t seed = 0)
+{
+    TDynamicMatrix<float> m(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            m[i][j] = noise(seed + i * n + j) * (1 + i % 3);
+        }
+    }
+    return m;
+}
+
+// ||a - b|| / ||b||
+static double relative_error(const TDynamicVector<float>& a, const TDynamicVector<float>& b)
+{
+    double d = 0, s = 0;
+
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        d += (a[i] - b[i]) * double(a[i] - b[i]);
+        s += b[i] * double(b[i]);
+    }
+    return sqrt(d / s);
+}
+
+TEST(TQuantizedMatrix, int8_dot_product_matches_scalar_loop)
+{
+    const size_t n = 77;
+    vector<int8_t> a(n), b(n);
+    int32_t expected = 0;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        a[i] = static_cast<int8_t>(int(i * 13 % 255) - 127);
+        b[i] = static_cast<int8_t>(127 - int(i * 29 % 255));
+        expected += int32_t(a[i]) * int32_t(b[i]);
+    }
+
+    EXPECT_EQ(dot_i8(a.data(), b.data(), n), expected);
+}
+
+TEST(TQuantizedMatrix, int8_dot_product_does_not_saturate_at_extremes)
+{
+    const size_t n = 64;
+    vector<int8_t> a(n, 127), b(n, -127);
+
+    EXPECT_EQ(dot_i8(a.data(), b.data(), n), -127 * 127 * 64);
+}
+
+TEST(TQuantizedMatrix, dequantization_error_is_within_half_scale)
+{
+    const size_t n = 40;
+    TDynamicMatrix<float> a = make_weights(n);
+    TQuantizedMatrix q(a);
+    TDynamicMatrix<float> d = q.dequantize();
+
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            EXPECT_LE(fabs(d[i][j] - a[i][j]), q.scale(i) * 0.5f + 1e-6f);
+        }
+    }
+}
+
+TEST(TQuantizedMatrix, zero_row_has_zero_scale)
+{
+    TDynamicMatrix<float> a(3);
+    a[1][1] = 2;
+    TQuantizedMatrix q(a);
+
+    EXPECT_EQ(q.scale(0), 0.0f);
+    EXPECT_EQ(q.dequantize(), a);
+}
+
+TEST(TQuantizedMatrix, quantized_gemv_is_close_to_float_gemv)
+{
+    const size_t n = 600;
+    TDynamicMatrix<float> a = make_weights(n);
+    TDynamicVector<float> x(n), y;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        x[i] = noise(7 * i + 1);
+    }
+    TNumThreadsGuard threads(4);
+    TQuantizedMatrix q(a);
+    q.multiply_to(x, y);
+
+    EXPECT_LT(relative_error(y, a * x), 0.02);
+}
+
+TEST(TQuantizedMatrix, quantized_gemm_is_close_to_float_gemm)
+{
+    const size_t n = 70;
+    TDynamicMatrix<float> a = make_weights(n), b = make_weights(n, 12345), c;
+    TQuantizedMatrix q(a, 32);
+
+    q.multiply_to(b, c);
+    TDynamicMatrix<float> expected = a * b;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        EXPECT_LT(relative_error(c[i], expected[i]), 0.02);
+    }
+}
+
+TEST(TQuantizedMatrix, per_block_scales_reduce_error_for_mixed_magnitudes)
+{
+    const size_t n = 64;
+    TDynamicMatrix<float> a(n);
+    TDynamicVector<float> x(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            a[i][j] = static_cast<float>(sin(double(i + 3 * j))) * (j < n / 2 ? 100.0f : 0.01f);
+        }
+        x[i] = i < n / 2 ? 0.0f : 1.0f;
+    }
+    TQuantizedMatrix rows(a), blocks(a, 16);
+    TDynamicVector<float> expected = a * x;
+
+    EXPECT_EQ(blocks.blocks(), 4);
+    EXPECT_LT(relative_error(blocks * x, expected), relative_error(rows * x, expected));
+}
+
+TEST(TQuantizedMatrix, cant_multiply_by_vector_with_not_equal_size)
+{
+    TQuantizedMatrix q(TDynamicMatrix<float>(3));
+    TDynamicVector<float> x(4), y(3);
+
+    ASSERT_ANY_THROW(q.multiply_to(x, y));
+}
@@ -0,0 +1,126 @@
+#include "tsemiring.h"
+
+#include <gtest.h>
+
+// матрица смежности с весами (нуль полукольца - нет ребра)
+template<typename S>
+static TDynamicMatrix<int> make_graph(size_t n, int seed)
+{
+    TDynamicMatrix<int> m(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            size_t h = (i * 31 + j * 17 + seed) % 13;
+            m[i][j] = (h < 4 && i != j) ? static_cast<int>(h + 1) : S::zero();
+        }
+    }
+    return m;
+}
+
+template<typename S>
+static TDynamicMatrix<int> naive_product(const TDynamicMatrix<int>& a, const TDynamicMatrix<int>& b)
+{
+    const size_t n = a.size();
+    TDynamicMatrix<int> res(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            int s = S::zero();
+            for (size_t k = 0; k < n; k++)
+            {
+                s = S::add(s, S::mul(a[i][k], b[k][j]));
+            }
+            res[i][j] = s;
+        }
+    }
+    return res;
+}
+
+TEST(TSemiring, plus_times_product_equals_operator_mul)
+{
+    TDynamicMatrix<int> a = make_graph<TPlusTimes<int>>(20, 1);
+    TDynamicMatrix<int> b = make_graph<TPlusTimes<int>>(20, 2);
+
+    EXPECT_EQ(semiring_multiply<TPlusTimes<int>>(a, b), a * b);
+}
+
+TEST(TSemiring, min_plus_product_matches_triple_loop)
+{
+    TDynamicMatrix<int> a = make_graph<TMinPlus<int>>(600, 1);
+    TDynamicMatrix<int> b = make_graph<TMinPlus<int>>(600, 5);
+
+    TNumThreadsGuard threads(4);
+    TDynamicMatrix<int> res = semiring_multiply<TMinPlus<int>>(a, b);
+
+    EXPECT_EQ(res, naive_product<TMinPlus<int>>(a, b));
+}
+
+TEST(TSemiring, min_plus_squaring_gives_shortest_paths)
+{
+    const size_t n = 4;
+    const double inf = TMinPlus<double>::zero();
+    TDynamicMatrix<double> d(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            d[i][j] = (i == j) ? 0 : inf;
+        }
+    }
+    d[0][1] = 5;
+    d[1][2] = 1;
+    d[2][3] = 1;
+    d[0][3] = 10;
+
+    TDynamicMatrix<double> d2 = semiring_multiply<TMinPlus<double>>(d, d);
+    TDynamicMatrix<double> d4 = semiring_multiply<TMinPlus<double>>(d2, d2);
+
+    EXPECT_EQ(d4[0][3], 7);
+    EXPECT_EQ(d4[0][2], 6);
+    EXPECT_EQ(d4[3][0], inf);
+}
+
+TEST(TSemiring, max_plus_and_max_min_products_match_triple_loop)
+{
+    TDynamicMatrix<int> a = make_graph<TMaxPlus<int>>(30, 3);
+    TDynamicMatrix<int> b = make_graph<TMaxPlus<int>>(30, 4);
+
+    EXPECT_EQ(semiring_multiply<TMaxPlus<int>>(a, b), naive_product<TMaxPlus<int>>(a, b));
+    EXPECT_EQ(semiring_multiply<TMaxMin<int>>(a, b), naive_product<TMaxMin<int>>(a, b));
+}
+
+TEST(TSemiring, packed_boolean_product_matches_triple_loop)
+{
+    TDynamicMatrix<int> a = make_graph<TOrAnd<int>>(130, 7);
+    TDynamicMatrix<int> b = make_graph<TOrAnd<int>>(130, 8);
+
+    for (size_t i = 0; i < 130; i++)
+    {
+        for (size_t j = 0; j < 130; j++)
+        {
+            a[i][j] = a[i][j] != 0;
+            b[i][j] = b[i][j] != 0;
+        }
+    }
+
+    EXPECT_EQ(semiring_multiply<TOrAnd<int>>(a, b), naive_product<TOrAnd<int>>(a, b));
+}
+
+TEST(TSemiring, cant_multiply_matrices_with_not_equal_size)
+{
+    TDynamicMatrix<int> a(3), b(4), res(3);
+
+    ASSERT_ANY_THROW(semiring_multiply_to<TMinPlus<int>>(a, b, res));
+}
+
+TEST(TSemiring, result_must_not_alias_operand)
+{
+    TDynamicMatrix<int> a(3), b(3);
+
+    ASSERT_ANY_THROW(semiring_multiply_to<TMinPlus<int>>(a, b, a));
+}
@@ -0,0 +1,232 @@
+#include "tsolvers.h"
+
+#include <gtest.h>
+
+// трёхдиагональная матрица -1, d, -1 (симметричная положительно определённая при d >= 2)
+static TDynamicMatrix<double> make_poisson_matrix(size_t n, double d = 2.0)
+{
+    TDynamicMatrix<double> m(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        m[i][i] = d;
+        if (i > 0)
+        {
+            m[i][i - 1] = -1;
+        }
+        if (i + 1 < n)
+        {
+            m[i][i + 1] = -1;
+        }
+    }
+    return m;
+}
+
+// несимметричная матрица с диагональным преобладанием
+static TDynamicMatrix<double> make_nonsymmetric_matrix(size_t n)
+{
+    TDynamicMatrix<double> m(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        m[i][i] = 4 + 0.1 * i;
+        if (i > 0)
+        {
+            m[i][i - 1] = -1.5;
+        }
+        if (i + 1 < n)
+        {
+            m[i][i + 1] = -0.5;
+        }
+        if (i + 3 < n)
+        {
+            m[i][i + 3] = 0.7;
+        }
+    }
+    return m;
+}
+
+static double residual_norm(TDynamicMatrix<double>& a, const TDynamicVector<double>& b, const TDynamicVector<double>& x)
+{
+    TDynamicVector<double> r = a * x;
+
+    return norm2(r - b) / norm2(b);
+}
+
+TEST(TSparseMatrix, can_create_from_triplets)
+{
+    TSparseMatrix<int> m(3, { {0, 0, 1}, {2, 1, 5}, {0, 2, 3}, {2, 1, 1} });
+
+    EXPECT_EQ(m.nonzeros(), 3);
+    EXPECT_EQ(m.get(2, 1), 6);
+    EXPECT_EQ(m.get(1, 1), 0);
+}
+
+TEST(TSparseMatrix, product_by_vector_is_equal_to_dense_one)
+{
+    TDynamicMatrix<double> a = make_nonsymmetric_matrix(20);
+    TSparseMatrix<double> s(a);
+    TDynamicVector<double> v(20);
+
+    for (size_t i = 0; i < 20; i++)
+    {
+        v[i] = 1.0 + i;
+    }
+
+    EXPECT_EQ(s * v, a * v);
+    EXPECT_EQ(s.toDense(), a);
+}
+
+TEST(TSolvers, cg_solves_symmetric_system)
+{
+    const size_t n = 50;
+
+    TDynamicMatrix<double> a = make_poisson_matrix(n);
+    TDynamicVector<double> b(n), x(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        b[i] = 1.0;
+    }
+    TSolverResult res = cg(a, b, x);
+
+    EXPECT_TRUE(res.converged);
+    EXPECT_LT(residual_norm(a, b, x), 1e-8);
+}
+
+TEST(TSolvers, jacobi_preconditioned_cg_converges)
+{
+    const size_t n = 40;
+
+    TDynamicMatrix<double> a = make_poisson_matrix(n, 3.0);
+    TDynamicVector<double> b(n), x(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        b[i] = static_cast<double>(i % 5);
+    }
+    TSolverResult res = cg(a, b, x, TJacobiPreconditioner<double>(a));
+
+    EXPECT_TRUE(res.converged);
+    EXPECT_LT(residual_norm(a, b, x), 1e-8);
+}
+
+TEST(TSolvers, bicgstab_with_ilu0_solves_sparse_system)
+{
+    const size_t n = 60;
+
+    TDynamicMatrix<double> a = make_nonsymmetric_matrix(n);
+    TSparseMatrix<double> s(a);
+    TDynamicVector<double> b(n), x(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        b[i] = 1.0 + (i % 3);
+    }
+    TSolverResult plain = bicgstab(s, b, x);
+    TDynamicVector<double> y(n);
+    TSolverResult res = bicgstab(s, b, y, TILU0Preconditioner<double>(s));
+
+    EXPECT_TRUE(res.converged);
+    EXPECT_LE(res.iterations, plain.iterations);
+    EXPECT_LT(residual_norm(a, b, y), 1e-8);
+}
+
+TEST(TSolvers, ilu0_is_exact_for_tridiagonal_matrix)
+{
+    const size_t n = 10;
+
+    TDynamicMatrix<double> a = make_poisson_matrix(n);
+    TDynamicVector<double> b(n), x(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        b[i] = 1.0;
+    }
+    TILU0Preconditioner<double> ilu(a);
+
+    ilu.apply(b, x);
+
+    EXPECT_LT(residual_norm(a, b, x), 1e-12);
+}
+
+TEST(TSolvers, ilu0_throws_for_interior_zero_pivot)
+{
+    // U[1][1] = 1 - 1 * 1 = 0, а строка 2 на столбец 1 не ссылается
+    TDynamicMatrix<double> a(3);
+
+    a[0][0] = 1;
+    a[0][1] = 1;
+    a[1][0] = 1;
+    a[1][1] = 1;
+    a[2][2] = 1;
+
+    ASSERT_ANY_THROW(TILU0Preconditioner<double> ilu(a));
+}
+
+TEST(TSolvers, restarted_gmres_solves_nonsymmetric_system)
+{
+    const size_t n = 80;
+
+    TDynamicMatrix<double> a = make_nonsymmetric_matrix(n);
+    TDynamicVector<double> b(n), x(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        b[i] = 1.0 / (i + 1);
+    }
+    TSolverResult res = gmres(a, b, x, TJacobiPreconditioner<double>(a), 10);
+
+    EXPECT_TRUE(res.converged);
+    EXPECT_LT(residual_norm(a, b, x), 1e-8);
+}
+
+TEST(TSolvers, solvers_accept_functor_operator)
+{
+    const size_t n = 30;
+
+    // y = A * x для трёхдиагональной матрицы без её хранения
+    auto op = [n](const TDynamicVector<double>& x, TDynamicVector<double>& y)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            y[i] = 2 * x[i] - (i > 0 ? x[i - 1] : 0) - (i + 1 < n ? x[i + 1] : 0);
+        }
+    };
+    TDynamicMatrix<double> a = make_poisson_matrix(n);
+    TDynamicVector<double> b(n), x(n), y(n);
+
+    b[0] = 1;
+    b[n - 1] = 1;
+
+    EXPECT_TRUE(cg(op, b, x).converged);
+    EXPECT_TRUE(gmres(op, b, y).converged);
+    EXPECT_LT(residual_norm(a, b, x), 1e-8);
+    EXPECT_LT(residual_norm(a, b, y), 1e-8);
+}
+
+TEST(TSolvers, cant_solve_with_wrong_initial_guess_size)
+{
+    TDynamicMatrix<double> a = make_poisson_matrix(5);
+    TDynamicVector<double> b(5), x(4);
+
+    ASSERT_ANY_THROW(cg(a, b, x));
+}
+
+TEST(TSolvers, gmres_reports_breakdown_on_singular_system)
+{
+    const size_t n = 4;
+
+    TDynamicMatrix<double> a(n);
+    TDynamicVector<double> b(n), x(n);
+
+    a[0][1] = 1;
+    b[1] = 1;
+    TSolverResult res = gmres(a, b, x);
+
+    EXPECT_FALSE(res.converged);
+    for (size_t i = 0; i < n; i++)
+    {
+        EXPECT_TRUE(std::isfinite(x[i]));
+    }
+}
@@ -0,0 +1,136 @@
+#include "tstream.h"
+
+#include <gtest.h>
+
+// цель test_matrix_cpp20 должна проверять именно сопрограммы, а не запасной вариант
+#if defined(TSTREAM_REQUIRE_COROUTINES) && !defined(TSTREAM_COROUTINES)
+#error "tstream.h did not enable coroutines in the C++20 build"
+#endif
+
+static TDynamicMatrix<double> make_matrix(size_t n)
+{
+    TDynamicMatrix<double> m(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            m[i][j] = double((i * 7 + j * 3) % 11) - 5;
+        }
+    }
+    return m;
+}
+
+static TDynamicVector<double> make_vector(size_t n)
+{
+    TDynamicVector<double> x(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        x[i] = double(i % 4) + 1;
+    }
+    return x;
+}
+
+TEST(TChannel, returns_items_in_order_until_closed)
+{
+    TChannel<int> c(2);
+
+    EXPECT_TRUE(c.push(1));
+    EXPECT_TRUE(c.push(2));
+    c.close();
+
+    EXPECT_FALSE(c.push(3));
+    EXPECT_EQ(*c.pop(), 1);
+    EXPECT_EQ(*c.pop(), 2);
+    EXPECT_FALSE(c.pop().has_value());
+}
+
+TEST(TChannel, bounded_channel_passes_all_items_between_threads)
+{
+    const int n = 1000;
+    TChannel<int> c(3);
+    thread producer([&c]()
+    {
+        for (int i = 0; i < n; i++)
+        {
+            c.push(i);
+        }
+        c.close();
+    });
+    int expected = 0;
+
+    while (auto v = c.pop())
+    {
+        EXPECT_EQ(*v, expected++);
+    }
+    producer.join();
+    EXPECT_EQ(expected, n);
+}
+
+TEST(TStream, row_blocks_yields_rows_in_blocks)
+{
+    stringstream s;
+    s << make_matrix(10);
+    auto src = row_blocks<double>(s, 10, 10, 4);
+    size_t rows = 0, blocks = 0;
+
+    while (auto b = src.next())
+    {
+        EXPECT_EQ(b->size(), blocks < 2 ? 4 : 2);
+        EXPECT_EQ((*b)[0][1], make_matrix(10)[rows][1]);
+        rows += b->size();
+        blocks++;
+    }
+    EXPECT_EQ(rows, 10);
+    EXPECT_EQ(blocks, 3);
+}
+
+TEST(TStream, row_blocks_rethrows_read_error)
+{
+    stringstream s;
+    s << make_matrix(3);
+    auto src = row_blocks<double>(s, 3, 5, 2);
+
+    EXPECT_EQ(src.next()->size(), 2);
+    ASSERT_ANY_THROW(src.next());
+}
+
+TEST(TStream, stream_gemv_matches_dense_product)
+{
+    const size_t n = 203;
+    TDynamicMatrix<double> a = make_matrix(n);
+    TDynamicVector<double> x = make_vector(n), y(n);
+    stringstream in, out;
+
+    in << a;
+    stream_gemv(in, out, x, n, [](TDynamicVector<double>& r) { r *= 2.0; }, 16, 2);
+    out >> y;
+
+    a *= 2.0;
+    EXPECT_EQ(y, a * x);
+}
+
+TEST(TStream, stream_gemv_throws_on_truncated_input)
+{
+    TDynamicVector<double> x = make_vector(5);
+    stringstream in("1 2 3 4 5\n6 7 8"), out;
+
+    ASSERT_ANY_THROW(stream_gemv(in, out, x, 2, [](TDynamicVector<double>&) {}, 1));
+}
+
+TEST(TStream, error_in_transform_stops_pipeline)
+{
+    const size_t n = 100;
+    TDynamicVector<double> x = make_vector(n);
+    stringstream in, out;
+    in << make_matrix(n);
+
+    ASSERT_ANY_THROW(stream_gemv(in, out, x, n, [](TDynamicVector<double>& r)
+    {
+        if (r[0] == 0)
+        {
+            throw("Error");
+        }
+    }, 4, 1));
+}
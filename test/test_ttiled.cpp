@@ -0,0 +1,148 @@
+#include "ttiled.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <gtest.h>
+
+// файл плиток во временном каталоге; удаляется и при падении теста
+struct TTempFile
+{
+    string path;
+
+    explicit TTempFile(const string& name)
+        : path((filesystem::temp_directory_path() /
+                (name + "_" + to_string(random_device()()) + ".bin")).string())
+    {
+    }
+    ~TTempFile() { remove(path.c_str()); }
+};
+
+// значения в [-6, 6] без короткого периода по строкам и столбцам
+static TDynamicMatrix<int> make_tiled_matrix(size_t n, int seed)
+{
+    TDynamicMatrix<int> m(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            m[i][j] = static_cast<int>((i * i + 5 * j + seed * (i ^ j)) % 13) - 6;
+        }
+    }
+    return m;
+}
+
+TEST(TTiledMatrix, can_create_tiled_matrix)
+{
+    TTempFile f("tiled_create");
+
+    ASSERT_NO_THROW(TTiledMatrix<double> m(f.path, 100, 32));
+}
+
+TEST(TTiledMatrix, is_not_limited_by_max_matrix_size)
+{
+    TTempFile f("tiled_large");
+    TTiledMatrix<char> m(f.path, 4 * MAX_MATRIX_SIZE, 4096);
+
+    m.set(4 * MAX_MATRIX_SIZE - 1, 3, 'x');
+
+    EXPECT_EQ(m.get(4 * MAX_MATRIX_SIZE - 1, 3), 'x');
+    EXPECT_EQ(m.get(0, 0), 0);
+}
+
+TEST(TTiledMatrix, cant_create_matrix_with_zero_tile)
+{
+    TTempFile f("tiled_zero");
+
+    ASSERT_ANY_THROW(TTiledMatrix<double> m(f.path, 100, 0));
+}
+
+TEST(TTiledMatrix, cant_create_matrix_with_too_large_tile)
+{
+    TTempFile f("tiled_huge_tile");
+
+    ASSERT_THROW(TTiledMatrix<char> m(f.path, 100, (size_t(1) << 16) + 1), out_of_range);
+}
+
+TEST(TTiledMatrix, dense_round_trip_keeps_elements)
+{
+    TDynamicMatrix<int> a = make_tiled_matrix(100, 1);
+    TTempFile f("tiled_dense");
+    TTiledMatrix<int> t(f.path, 100, 32);
+
+    t.assign(a);
+
+    EXPECT_EQ(t.toDense(), a);
+    EXPECT_EQ(t.get(99, 64), a[99][64]);
+}
+
+TEST(TTiledMatrix, can_reopen_existing_file)
+{
+    TDynamicMatrix<int> a = make_tiled_matrix(50, 2);
+    TTempFile f("tiled_reopen");
+    {
+        TTiledMatrix<int> t(f.path, 50, 16);
+        t.assign(a);
+    }
+    TTiledMatrix<int> t(f.path, 50, 16, false);
+
+    EXPECT_EQ(t.toDense(), a);
+    ASSERT_ANY_THROW(TTiledMatrix<int> w(f.path, 70, 16, false));
+}
+
+TEST(TTiledMatrix, tiled_product_equals_dense_product)
+{
+    const size_t n = 150;
+    TDynamicMatrix<int> a = make_tiled_matrix(n, 3), b = make_tiled_matrix(n, 4);
+    TTempFile fa("tiled_a"), fb("tiled_b"), fc("tiled_c");
+    TTiledMatrix<int> ta(fa.path, n, 64), tb(fb.path, n, 64), tc(fc.path, n, 64);
+
+    ta.assign(a);
+    tb.assign(b);
+    TNumThreadsGuard threads(4);
+    multiply(ta, tb, tc);
+
+    EXPECT_EQ(tc.toDense(), a * b);
+}
+
+TEST(TTiledMatrix, each_tile_of_first_operand_is_read_once)
+{
+    const size_t n = 64;
+    TTempFile fa("tiled_a"), fb("tiled_b"), fc("tiled_c");
+    TTiledMatrix<float> ta(fa.path, n, 16), tb(fb.path, n, 16), tc(fc.path, n, 16);
+
+    TTiledStats s = multiply(ta, tb, tc);
+
+    // 4 x 4 плитки: A читается по строке плиток (16 чтений), B - на каждом
+    // из 64 шагов; остальные 48 использований плиток A идут из памяти
+    EXPECT_EQ(s.loads, 16 + 64);
+    EXPECT_EQ(s.reuses, 64 - 16);
+}
+
+TEST(TTiledMatrix, product_under_tile_budget_equals_dense_product)
+{
+    const size_t n = 60;
+    TDynamicMatrix<int> a = make_tiled_matrix(n, 5), b = make_tiled_matrix(n, 6);
+    TTempFile fa("tiled_a"), fb("tiled_b"), fc("tiled_c");
+    TTiledMatrix<int> ta(fa.path, n, 16), tb(fb.path, n, 16), tc(fc.path, n, 16);
+
+    ta.assign(a);
+    tb.assign(b);
+    // в памяти по 2 плитки строки A: строка делится на 2 части, и для второй
+    // части частичные суммы C (16 плиток) перечитываются
+    TTiledStats s = multiply(ta, tb, tc, 5);
+
+    EXPECT_EQ(tc.toDense(), a * b);
+    EXPECT_EQ(s.loads, 16 + 64 + 16);
+    EXPECT_EQ(s.reuses, 64 - 16);
+    ASSERT_ANY_THROW(multiply(ta, tb, tc, 3));
+}
+
+TEST(TTiledMatrix, cant_multiply_matrices_with_different_tiles)
+{
+    TTempFile fa("tiled_a"), fb("tiled_b"), fc("tiled_c");
+    TTiledMatrix<int> a(fa.path, 10, 4), b(fb.path, 10, 5), c(fc.path, 10, 4);
+
+    ASSERT_ANY_THROW(multiply(a, b, c));
+}
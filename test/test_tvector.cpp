@@ -419,4 +419,470 @@ TEST(TDynamicVector, cant_multiply_vectors_with_not_equal_size)
 	v2[4] = 5;
 
 	ASSERT_ANY_THROW(v1 * v2);
-}
\ No newline at end of file
+}
+
+TEST(TDynamicVector, can_add_vector_in_place)
+{
+	const int size = 3;
+
+	TDynamicVector<int> v1(size), v2(size), res(size);
+
+	for (int i = 0; i < size; i++)
+	{
+		v1[i] = i;
+		v2[i] = 10 * i;
+		res[i] = 11 * i;
+	}
+	v1 += v2;
+
+	ASSERT_EQ(v1, res);
+}
+
+TEST(TDynamicVector, can_subtract_vector_in_place)
+{
+	const int size = 3;
+
+	TDynamicVector<int> v1(size), v2(size), res(size);
+
+	for (int i = 0; i < size; i++)
+	{
+		v1[i] = 5 * i;
+		v2[i] = i;
+		res[i] = 4 * i;
+	}
+	v1 -= v2;
+
+	ASSERT_EQ(v1, res);
+}
+
+TEST(TDynamicVector, cant_add_vector_with_not_equal_size_in_place)
+{
+	TDynamicVector<int> v1(3), v2(4);
+
+	ASSERT_ANY_THROW(v1 += v2);
+}
+
+TEST(TDynamicVector, compound_scalar_operations_keep_memory)
+{
+	TDynamicVector<int> v(3);
+
+	v[0] = 1;
+	v[1] = 2;
+	v[2] = 3;
+
+	const int* mem = v.data();
+
+	v += 1;
+	v *= 3;
+	v -= 2;
+
+	EXPECT_EQ(mem, v.data());
+	EXPECT_EQ(v[0], 4);
+	EXPECT_EQ(v[1], 7);
+	EXPECT_EQ(v[2], 10);
+}
+
+TEST(TDynamicVector, can_make_axpy_update)
+{
+	const int size = 4;
+
+	TDynamicVector<int> y(size), x(size), res(size);
+
+	for (int i = 0; i < size; i++)
+	{
+		y[i] = i;
+		x[i] = 1;
+		res[i] = i + 3;
+	}
+	y.axpy(3, x);
+
+	ASSERT_EQ(y, res);
+}
+
+TEST(TDynamicVector, copy_shares_memory_in_cow_mode)
+{
+	TDynamicVector<int> v1(5);
+
+	v1.set_cow(true);
+
+	TDynamicVector<int> v2(v1);
+	const TDynamicVector<int>& c2 = v2;
+
+	EXPECT_EQ(c2.data(), static_cast<const TDynamicVector<int>&>(v1).data());
+	EXPECT_TRUE(v1.is_shared());
+}
+
+TEST(TDynamicVector, write_to_cow_copy_does_not_change_source)
+{
+	TDynamicVector<int> v1(5);
+
+	v1[0] = 1;
+	v1.set_cow(true);
+
+	TDynamicVector<int> v2(v1);
+	TDynamicVector<int> v3(5);
+
+	v3 = v1;
+	v2[0] = 7;
+	v3 += v3;
+
+	EXPECT_EQ(v1[0], 1);
+	EXPECT_EQ(v2[0], 7);
+	EXPECT_EQ(v3[0], 2);
+	EXPECT_FALSE(v1.is_shared());
+}
+
+TEST(TDynamicVector, cow_copy_is_not_changed_through_earlier_reference)
+{
+	TDynamicVector<int> v(5);
+
+	v.set_cow(true);
+	int& r = v[0];
+	TDynamicVector<int> w = v;
+	TDynamicVector<int> u(5);
+
+	u = v;
+	r = 42;
+
+	EXPECT_EQ(v[0], 42);
+	EXPECT_EQ(w[0], 0);
+	EXPECT_EQ(u[0], 0);
+	EXPECT_TRUE(w.is_cow());
+}
+
+TEST(TDynamicVector, cow_copy_is_not_changed_through_earlier_pointer)
+{
+	TDynamicVector<int> v(5);
+
+	v.set_cow(true);
+	int* p = v.data();
+	TDynamicVector<int> w(v);
+	p[1] = 42;
+
+	EXPECT_EQ(w[1], 0);
+	v.set_cow(true);
+	TDynamicVector<int> x(v);
+	EXPECT_TRUE(v.is_shared());
+	EXPECT_EQ(x[1], 42);
+}
+
+TEST(TDynamicVector, assignment_keeps_cow_mode_of_destination)
+{
+	TDynamicVector<int> a(3), c(3), d(4);
+
+	a.set_cow(true);
+	a = c;
+	TDynamicVector<int> b(a);
+
+	EXPECT_TRUE(a.is_cow());
+	EXPECT_TRUE(a.is_shared());
+
+	a = d;
+	TDynamicVector<int> e(a);
+
+	EXPECT_TRUE(a.is_cow());
+	EXPECT_TRUE(a.is_shared());
+	EXPECT_FALSE(c.is_cow());
+}
+
+TEST(TDynamicVector, copy_has_own_memory_without_cow_mode)
+{
+	TDynamicVector<int> v1(5);
+	TDynamicVector<int> v2(v1);
+	const TDynamicVector<int>& c1 = v1;
+	const TDynamicVector<int>& c2 = v2;
+
+	EXPECT_NE(c1.data(), c2.data());
+}
+
+TEST(TDynamicVector, cow_copies_are_thread_safe)
+{
+	const int size = 1000;
+
+	TDynamicVector<int> v(size);
+
+	for (int i = 0; i < size; i++)
+	{
+		v[i] = i;
+	}
+	v.set_cow(true);
+
+	vector<thread> workers;
+
+	for (int t = 0; t < 4; t++)
+	{
+		workers.emplace_back([&v, t]()
+		{
+			for (int k = 0; k < 100; k++)
+			{
+				TDynamicVector<int> copy(v);
+				copy[k] = -t;
+			}
+		});
+	}
+	for (auto& w : workers)
+	{
+		w.join();
+	}
+
+	EXPECT_FALSE(v.is_shared());
+	for (int i = 0; i < size; i++)
+	{
+		ASSERT_EQ(v[i], i);
+	}
+}
+
+TEST(TDynamicVector, first_touch_vector_is_zero_initialized)
+{
+	const int size = 100000;
+
+	TNumThreadsGuard threads(4);
+	TDynamicVector<int> v(size, TNumaPolicy::FirstTouch);
+
+	for (int i = 0; i < size; i++)
+	{
+		ASSERT_EQ(v[i], 0);
+	}
+}
+
+TEST(TDynamicVector, can_create_large_vector_in_every_huge_page_mode)
+{
+	const size_t size = (size_t(3) << 20) / sizeof(double) + 7;
+
+	THugePages modes[] = { THugePages::Default, THugePages::None, THugePages::Transparent, THugePages::Explicit };
+
+	for (THugePages mode : modes)
+	{
+		set_huge_pages(mode);
+
+		TDynamicVector<double> v(size);
+
+		v[size - 1] = 1.5;
+
+		TDynamicVector<double> copy(v);
+
+		EXPECT_EQ(copy[size - 1], 1.5);
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(copy.data()) % STORAGE_PAGE_SIZE, 0u);
+	}
+	set_huge_pages(THugePages::Default);
+}
+
+TEST(TDynamicVector, all_reduction_modes_give_exact_integer_dot_product)
+{
+	const int size = 1000;
+
+	TDynamicVector<int> v1(size), v2(size);
+
+	for (int i = 0; i < size; i++)
+	{
+		v1[i] = i % 7 - 3;
+		v2[i] = i % 5 + 1;
+	}
+	int expected = v1 * v2;
+
+	EXPECT_EQ(v1.dot(v2, TReduction::Naive), expected);
+	EXPECT_EQ(v1.dot(v2, TReduction::Pairwise), expected);
+	EXPECT_EQ(v1.dot(v2, TReduction::Kahan), expected);
+	EXPECT_EQ(v1.dot(v2, TReduction::Wide), expected);
+}
+
+TEST(TDynamicVector, compensated_float_dot_product_is_more_accurate)
+{
+	const int size = 1 << 20;
+
+	TDynamicVector<float> v1(size), v2(size);
+	double exact = 0;
+
+	for (int i = 0; i < size; i++)
+	{
+		v1[i] = 1.0f + (i % 1000) * 1e-3f;
+		v2[i] = 0.1f;
+		exact += static_cast<double>(v1[i]) * static_cast<double>(v2[i]);
+	}
+	double naive = fabs(v1.dot(v2, TReduction::Naive) - exact);
+
+	EXPECT_LT(fabs(v1.dot(v2, TReduction::Pairwise) - exact), naive / 10);
+	EXPECT_LT(fabs(v1.dot(v2, TReduction::Kahan) - exact), naive / 10);
+	EXPECT_LT(fabs(v1.dot(v2, TReduction::Wide) - exact), exact * 1e-7);
+}
+
+TEST(TDynamicVector, can_sum_elements)
+{
+	TDynamicVector<double> v(1001);
+
+	for (int i = 0; i < 1001; i++)
+	{
+		v[i] = i;
+	}
+
+	EXPECT_EQ(v.sum(), 500500.0);
+	EXPECT_EQ(v.sum(TReduction::Kahan), 500500.0);
+}
+
+TEST(TDynamicVector, cant_take_dot_product_of_vectors_with_not_equal_size)
+{
+	TDynamicVector<double> v1(3), v2(4);
+
+	ASSERT_ANY_THROW(v1.dot(v2, TReduction::Kahan));
+}
+
+TEST(TDynamicVector, parallel_dot_product_does_not_depend_on_thread_count)
+{
+	const int size = 1 << 20;
+
+	TDynamicVector<float> v1(size), v2(size);
+
+	for (int i = 0; i < size; i++)
+	{
+		v1[i] = sinf(float(i));
+		v2[i] = cosf(float(i) * 0.5f);
+	}
+	TNumThreadsGuard threads(1);
+	float pairwise = v1.dot(v2, TReduction::Pairwise);
+	float kahan = v1.dot(v2, TReduction::Kahan);
+	float sum = v1.sum(TReduction::Wide);
+	set_num_threads(3);
+
+	EXPECT_EQ(v1.dot(v2, TReduction::Pairwise), pairwise);
+	EXPECT_EQ(v1.dot(v2, TReduction::Kahan), kahan);
+	EXPECT_EQ(v1.sum(TReduction::Wide), sum);
+}
+
+TEST(TDynamicVector, can_compute_norms)
+{
+	TDynamicVector<double> v(4);
+
+	v[0] = 3;
+	v[1] = -4;
+	v[2] = 0;
+	v[3] = 12;
+
+	EXPECT_DOUBLE_EQ(v.norm1(), 19.0);
+	EXPECT_DOUBLE_EQ(v.norm2(), 13.0);
+	EXPECT_DOUBLE_EQ(v.norm_inf(), 12.0);
+	EXPECT_DOUBLE_EQ(v.mean(), 2.75);
+}
+
+TEST(TDynamicVector, argmax_and_argmin_return_first_extreme_element)
+{
+	const int size = 100000;
+
+	TDynamicVector<int> v(size);
+
+	for (int i = 0; i < size; i++)
+	{
+		v[i] = i % 1000;
+	}
+	v[70000] = -5;
+	v[90000] = -5;
+
+	EXPECT_EQ(v.argmax(), 999);
+	EXPECT_EQ(v.argmin(), 70000);
+	EXPECT_EQ(v.max_value(), 999);
+	EXPECT_EQ(v.min_value(), -5);
+}
+
+TEST(TDynamicVector, can_map_and_apply_function)
+{
+	TDynamicVector<int> v(5);
+
+	for (int i = 0; i < 5; i++)
+	{
+		v[i] = i;
+	}
+	TDynamicVector<int> sq = v.map([](int x) { return x * x; });
+	v.apply([](int x) { return x + 1; });
+
+	EXPECT_EQ(sq[4], 16);
+	EXPECT_EQ(v[4], 5);
+}
+
+TEST(TDynamicVector, map_does_not_change_cow_copy)
+{
+	TDynamicVector<int> v(3);
+
+	v.set_cow(true);
+	TDynamicVector<int> c(v);
+	c.apply([](int x) { return x + 1; });
+
+	EXPECT_EQ(v[0], 0);
+	EXPECT_EQ(c[0], 1);
+}
+
+TEST(TDynamicVector, can_zip_several_vectors_in_one_pass)
+{
+	const int size = 300000;
+
+	TDynamicVector<double> a(size), b(size), c(size);
+
+	for (int i = 0; i < size; i++)
+	{
+		a[i] = i;
+		b[i] = 2;
+		c[i] = -i;
+	}
+	TNumThreadsGuard threads(4);
+	TDynamicVector<double> res = zip([](double x, double y, double z) { return x * y + z; }, a, b, c);
+
+	EXPECT_EQ(res, a);
+}
+
+TEST(TDynamicVector, can_apply_elementwise_functions)
+{
+	TDynamicVector<double> a(3), b(3);
+
+	a[0] = -2;
+	a[1] = 0;
+	a[2] = 6;
+	b[0] = 4;
+	b[1] = 1;
+	b[2] = 3;
+
+	EXPECT_EQ(hadamard(a, b)[0], -8);
+	EXPECT_EQ(divide(a, b)[2], 2);
+	EXPECT_EQ(abs(a)[0], 2);
+	EXPECT_DOUBLE_EQ(exp(a)[1], 1.0);
+	EXPECT_EQ(clamp(a, -1.0, 1.0)[0], -1);
+	EXPECT_EQ(clamp(a, -1.0, 1.0)[2], 1);
+}
+
+TEST(TDynamicVector, cant_zip_vectors_with_not_equal_size)
+{
+	TDynamicVector<int> v1(3), v2(4);
+
+	ASSERT_ANY_THROW(hadamard(v1, v2));
+}
+
+TEST(TDynamicVector, size_limit_can_be_changed_at_runtime)
+{
+	set_max_vector_size(10);
+	EXPECT_NO_THROW(TDynamicVector<int> v(10));
+	EXPECT_THROW(TDynamicVector<int> v(11), out_of_range);
+	set_max_vector_size(MAX_VECTOR_SIZE);
+
+	EXPECT_EQ(get_max_vector_size(), MAX_VECTOR_SIZE);
+	EXPECT_NO_THROW(TDynamicVector<int> v(11));
+}
+
+TEST(TDynamicVector, array_constructor_checks_size_limit_and_byte_size)
+{
+	int arr[11] = {};
+
+	set_max_vector_size(10);
+	EXPECT_THROW(TDynamicVector<int> v(arr, 11), out_of_range);
+	set_max_vector_size(SIZE_MAX);
+	EXPECT_THROW(TDynamicVector<int> v(arr, SIZE_MAX / 2), out_of_range);
+	set_max_vector_size(MAX_VECTOR_SIZE);
+
+	EXPECT_NO_THROW(TDynamicVector<int> v(arr, 11));
+}
+
+TEST(TDynamicVector, throws_when_byte_size_overflows)
+{
+	set_max_vector_size(SIZE_MAX);
+	EXPECT_THROW(TDynamicVector<double> v(SIZE_MAX / 4), out_of_range);
+	set_max_vector_size(MAX_VECTOR_SIZE);
+
+	EXPECT_EQ(checked_mul(size_t(1) << 31, size_t(1) << 31), size_t(1) << 62);
+	EXPECT_THROW(checked_mul(size_t(1) << 32, size_t(1) << 32), out_of_range);
+}